@@ -3,7 +3,7 @@ QT       += core network xml sql
 lessThan(QT_MAJOR_VERSION, 5) {
     QT   += gui
 } else {
-    QT   += widgets
+    QT   += widgets concurrent
 }
 
 macx {
@@ -22,17 +22,28 @@ SOURCES += src/main.cpp \
     src/mainwindow.cpp \
     src/dialogs/aboutdialog.cpp \
     src/dialogs/downloaddialog.cpp \
+    src/dialogs/infobundle.cpp \
     src/dialogs/logdialog.cpp \
     src/dialogs/settingsdialog.cpp \
     src/dialogs/v64converter.cpp \
+    src/emulation/emulatorbenchmark.cpp \
     src/emulation/emulatorhandler.cpp \
+    src/emulation/emulatorlog.cpp \
+    src/emulation/emulatorprocess.cpp \
+    src/emulation/emulatorsession.cpp \
+    src/emulation/romprefetcher.cpp \
+    src/emulation/telemetry.cpp \
+    src/roms/networkclient.cpp \
     src/roms/romcollection.cpp \
+    src/roms/romscanner.cpp \
     src/roms/thegamesdbscraper.cpp \
     src/views/gridview.cpp \
     src/views/listview.cpp \
     src/views/tableview.cpp \
     src/views/ddview.cpp \
     src/views/widgets/clickablewidget.cpp \
+    src/views/widgets/performancegraph.cpp \
+    src/views/widgets/sessionlist.cpp \
     src/views/widgets/treewidgetitem.cpp
 
 HEADERS += src/global.h \
@@ -40,17 +51,28 @@ HEADERS += src/global.h \
     src/mainwindow.h \
     src/dialogs/aboutdialog.h \
     src/dialogs/downloaddialog.h \
+    src/dialogs/infobundle.h \
     src/dialogs/logdialog.h \
     src/dialogs/settingsdialog.h \
     src/dialogs/v64converter.h \
+    src/emulation/emulatorbenchmark.h \
     src/emulation/emulatorhandler.h \
+    src/emulation/emulatorlog.h \
+    src/emulation/emulatorprocess.h \
+    src/emulation/emulatorsession.h \
+    src/emulation/romprefetcher.h \
+    src/emulation/telemetry.h \
+    src/roms/networkclient.h \
     src/roms/romcollection.h \
+    src/roms/romscanner.h \
     src/roms/thegamesdbscraper.h \
     src/views/gridview.h \
     src/views/listview.h \
     src/views/tableview.h \
     src/views/ddview.h \
     src/views/widgets/clickablewidget.h \
+    src/views/widgets/performancegraph.h \
+    src/views/widgets/sessionlist.h \
     src/views/widgets/treewidgetitem.h
 
 RESOURCES += resources/cen64qt.qrc
@@ -34,10 +34,14 @@
 #include "global.h"
 
 #include <QColor>
+#include <QDateTime>
 #include <QDir>
 #include <QEventLoop>
 #include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QLocale>
+#include <QRegExp>
 #include <QSize>
 
 #include <quazip5/quazip.h>
@@ -138,13 +142,13 @@ int getDefaultWidth(QString id, int imageWidth)
         return 250;
     else if (id == "Internal Name" || id == "Publisher" || id == "Developer")
         return 200;
-    else if (id == "ESRB" || id == "Genre")
+    else if (id == "ESRB" || id == "Genre" || id == "Last Played")
         return 150;
     else if (id == "Save Type" || id == "Release Date")
         return 100;
     else if (id == "CRC1" || id == "CRC2")
         return 90;
-    else if (id == "Size" || id == "Rumble" || id == "Players" || id == "Rating")
+    else if (id == "Size" || id == "Rumble" || id == "Players" || id == "Rating" || id == "Times Played")
         return 75;
     else if (id == "Game Cover")
         return imageWidth;
@@ -260,6 +264,10 @@ QString getRomInfo(QString identifier, const Rom *rom, bool removeWarn, bool sor
         text = rom->developer;
     else if (identifier == "Rating")
         text = rom->rating;
+    else if (identifier == "Last Played" && rom->lastPlayed > 0)
+        text = QLocale().toString(QDateTime::fromMSecsSinceEpoch(rom->lastPlayed), QLocale::ShortFormat);
+    else if (identifier == "Times Played" && rom->playCount > 0)
+        text = QString::number(rom->playCount);
 
     if (!removeWarn)
         return text;
@@ -323,6 +331,24 @@ int getTextSize()
 }
 
 
+QString getSearchName(const Rom *currentRom)
+{
+    QString search;
+
+    if (currentRom->goodName != getTranslation("Unknown ROM") &&
+        currentRom->goodName != getTranslation("Requires catalog file")) {
+        search = currentRom->goodName;
+    } else {
+        //tweak internal name by adding spaces to get better results
+        search = currentRom->internalName;
+        search.replace(QRegExp("([a-z])([A-Z])"),"\\1 \\2");
+        search.replace(QRegExp("([^ \\d])(\\d)"),"\\1 \\2");
+    }
+
+    return search;
+}
+
+
 QString getTranslation(QString text)
 {
     if (text == "GoodName")                     return QObject::tr("GoodName");
@@ -346,6 +372,8 @@ QString getTranslation(QString text)
     else if (text == "Developer")               return QObject::tr("Developer");
     else if (text == "Rating")                  return QObject::tr("Rating");
     else if (text == "Game Cover")              return QObject::tr("Game Cover");
+    else if (text == "Last Played")             return QObject::tr("Last Played");
+    else if (text == "Times Played")            return QObject::tr("Times Played");
     else if (text == "Unknown ROM")             return QObject::tr("Unknown ROM");
     else if (text == "Requires catalog file")   return QObject::tr("Requires catalog file");
     else if (text == "Not found")               return QObject::tr("Not found");
@@ -389,6 +417,51 @@ QByteArray *getZippedRom(QString romFileName, QString zipFile)
 }
 
 
+void loadGameInfo(Rom *currentRom)
+{
+    if (SETTINGS.value("Other/downloadinfo", "").toString() != "true")
+        return;
+
+    QString dataFile = getCacheLocation() + currentRom->romMD5.toLower() + "/data.json";
+    QFile file(dataFile);
+
+    file.open(QIODevice::ReadOnly);
+    QString data = file.readAll();
+    file.close();
+
+    QJsonDocument document = QJsonDocument::fromJson(data.toUtf8());
+    QJsonObject json = document.object();
+
+    //Remove any non-standard characters
+    QString regex = "[^A-Za-z 0-9 \\.,\\?'""!@#\\$%\\^&\\*\\(\\)-_=\\+;:<>\\/\\\\|\\}\\{\\[\\]`~é]*";
+
+    currentRom->gameTitle = json.value("game_title").toString().remove(QRegExp(regex));
+    if (currentRom->gameTitle == "") currentRom->gameTitle = getTranslation("Not found");
+
+    currentRom->releaseDate = json.value("release_date").toString();
+    currentRom->sortDate = json.value("release_date").toString();
+    currentRom->releaseDate.replace(QRegExp("(\\d{4})-(\\d{2})-(\\d{2})"), "\\2/\\3/\\1");
+
+    currentRom->overview = json.value("overview").toString().remove(QRegExp(regex));
+    currentRom->esrb = json.value("rating").toString();
+
+    currentRom->genre = json.value("genres").toString();
+    currentRom->publisher = json.value("publisher").toString();
+    currentRom->developer = json.value("developer").toString();
+
+    foreach (QString ext, QStringList() << "jpg" << "png")
+    {
+        QString imageFile = getCacheLocation() + currentRom->romMD5.toLower() + "/boxart-front." + ext;
+        QFile cover(imageFile);
+
+        if (cover.exists() && currentRom->image.load(imageFile)) {
+            currentRom->imageExists = true;
+            break;
+        }
+    }
+}
+
+
 bool romSorter(const Rom &firstRom, const Rom &lastRom)
 {
     QString sort, direction;
@@ -417,6 +490,17 @@ bool romSorter(const Rom &firstRom, const Rom &lastRom)
     } else if (sort == "Release Date") {
         sortFirst = firstRom.sortDate;
         sortLast = lastRom.sortDate;
+    } else if (sort == "Last Played" || sort == "Times Played") {
+        qint64 firstValue = sort == "Last Played" ? firstRom.lastPlayed : firstRom.playCount;
+        qint64 lastValue = sort == "Last Played" ? lastRom.lastPlayed : lastRom.playCount;
+
+        //Most ROMs were never played, those fall through to the filename below
+        if (firstValue != lastValue) {
+            if (direction == "descending")
+                return firstValue > lastValue;
+            else
+                return firstValue < lastValue;
+        }
     } else {
         sortFirst = getRomInfo(sort, &firstRom, true, true);
         sortLast = getRomInfo(sort, &lastRom, true, true);
@@ -33,8 +33,9 @@
 #define COMMON_H
 
 #include <QGraphicsDropShadowEffect>
+#include <QImage>
+#include <QMetaType>
 #include <QString>
-#include <QPixmap>
 
 class QColor;
 class QSize;
@@ -68,12 +69,17 @@ struct Rom {
     QString developer;
     QString rating;
 
-    QPixmap image;
+    qint64 lastPlayed = 0;
+    int playCount = 0;
+
+    QImage image;
 
     int count;
     bool imageExists;
 };
 
+Q_DECLARE_METATYPE(Rom)
+
 bool romSorter(const Rom &firstRom, const Rom &lastRom);
 int getDefaultWidth(QString id, int imageWidth);
 int getGridSize(QString which);
@@ -91,6 +97,8 @@ QSize getImageSize(QString view);
 QString getCacheLocation();
 QString getDataLocation();
 QString getRomInfo(QString identifier, const Rom *rom, bool removeWarn = false, bool sort = false);
+QString getSearchName(const Rom *currentRom);
 QString getVersion();
+void loadGameInfo(Rom *currentRom);
 
 #endif // COMMON_H
@@ -0,0 +1,250 @@
+/***
+ * Copyright (c) 2013, Dan Hasting
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "infobundle.h"
+
+#include "../global.h"
+#include "../common.h"
+
+#include <QApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileDialog>
+#include <QJsonDocument>
+#include <QMessageBox>
+#include <QRegExp>
+#include <QSaveFile>
+
+#include <quazip5/quazip.h>
+#include <quazip5/quazipfile.h>
+#include <quazip5/quazipnewinfo.h>
+
+
+InfoBundle::InfoBundle(Mode mode, QWidget *parent) : QObject(parent)
+{
+    QString defaultFile = QDir::home().absoluteFilePath(AppNameLower + "-info.zip");
+    QString filter = tr("Info Bundles") + " (*.zip);;" + tr("All Files") + " (*)";
+
+    if (mode == Export) {
+        QString bundleFile = QFileDialog::getSaveFileName(parent, tr("Export Game Information"),
+                                                          defaultFile, filter);
+        if (bundleFile != "")
+            runExport(bundleFile, parent);
+    } else {
+        QString bundleFile = QFileDialog::getOpenFileName(parent, tr("Import Game Information"),
+                                                          QDir::homePath(), filter);
+        if (bundleFile != "")
+            runImport(bundleFile, parent);
+    }
+}
+
+
+QStringList InfoBundle::getBundleFiles(QString identifier)
+{
+    QDir gameCache(getCacheLocation() + identifier);
+
+    return gameCache.entryList(QStringList() << "data.json" << "boxart-front.jpg" << "boxart-front.png",
+                               QDir::Files, QDir::Name);
+}
+
+
+QString InfoBundle::hashFile(QString fileName)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly))
+        return "";
+
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(&file);
+    file.close();
+
+    return hash.result().toHex();
+}
+
+
+bool InfoBundle::isBundleEntry(QString entryName)
+{
+    //Only write where an export would have read from, whatever the archive claims
+    QStringList parts = entryName.split("/");
+
+    if (parts.size() != 2 || !QRegExp("[0-9a-f]{32}").exactMatch(parts.at(0)))
+        return false;
+
+    return parts.at(1) == "data.json" || parts.at(1) == "boxart-front.jpg" || parts.at(1) == "boxart-front.png";
+}
+
+
+void InfoBundle::runExport(QString bundleFile, QWidget *parent)
+{
+    QString title = tr("Export Game Information");
+    QDir cache(getCacheLocation());
+    QStringList identifiers = cache.entryList(QStringList() << "????????????????????????????????",
+                                              QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+
+    //The index goes first so an import can skip unchanged files without unpacking them
+    QJsonObject index;
+
+    foreach (QString identifier, identifiers)
+    {
+        QJsonObject hashes;
+
+        foreach (QString fileName, getBundleFiles(identifier))
+            hashes.insert(fileName, hashFile(cache.absoluteFilePath(identifier + "/" + fileName)));
+
+        if (!hashes.isEmpty())
+            index.insert(identifier, hashes);
+    }
+
+    QuaZip zip(bundleFile);
+
+    if (!zip.open(QuaZip::mdCreate)) {
+        QApplication::restoreOverrideCursor();
+        QMessageBox::warning(parent, title, tr("Unable to create") + " \"" + bundleFile + "\"");
+        return;
+    }
+
+    QuaZipFile entry(&zip);
+
+    entry.open(QIODevice::WriteOnly, QuaZipNewInfo("index.json"));
+    entry.write(QJsonDocument(index).toJson(QJsonDocument::Compact));
+    entry.close();
+
+    int count = 0;
+
+    foreach (QString identifier, index.keys())
+    {
+        foreach (QString fileName, index.value(identifier).toObject().keys())
+        {
+            QString entryName = identifier + "/" + fileName;
+            QFile file(cache.absoluteFilePath(entryName));
+
+            if (!file.open(QIODevice::ReadOnly))
+                continue;
+
+            //Covers are already compressed, so store them instead of deflating again
+            int method = fileName == "data.json" ? Z_DEFLATED : 0;
+
+            entry.open(QIODevice::WriteOnly, QuaZipNewInfo(entryName, file.fileName()), nullptr, 0, method);
+            entry.write(file.readAll());
+            entry.close();
+            file.close();
+        }
+
+        count++;
+    }
+
+    zip.close();
+    QApplication::restoreOverrideCursor();
+
+    if (zip.getZipError() != UNZ_OK)
+        QMessageBox::warning(parent, title, tr("Unable to write") + " \"" + bundleFile + "\"");
+    else
+        QMessageBox::information(parent, title, tr("Exported information for %1 games.").arg(count));
+}
+
+
+void InfoBundle::runImport(QString bundleFile, QWidget *parent)
+{
+    QString title = tr("Import Game Information");
+    QuaZip zip(bundleFile);
+
+    if (!zip.open(QuaZip::mdUnzip) || !zip.setCurrentFile("index.json")) {
+        QMessageBox::warning(parent, title, "\"" + bundleFile + "\" " + tr("is not a valid info bundle!"));
+        return;
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+
+    QuaZipFile entry(&zip);
+
+    entry.open(QIODevice::ReadOnly);
+    QJsonObject index = QJsonDocument::fromJson(entry.readAll()).object();
+    entry.close();
+
+    int imported = 0, skipped = 0;
+
+    //Walk the archive in order, only unpacking what differs from the local cache
+    for (bool more = zip.goToFirstFile(); more; more = zip.goToNextFile())
+    {
+        QString entryName = zip.getCurrentFileName();
+
+        if (!isBundleEntry(entryName))
+            continue;
+
+        QString identifier = entryName.section("/", 0, 0);
+        QString fileName = entryName.section("/", 1, 1);
+        QString localFile = getCacheLocation() + entryName;
+        QString hash = index.value(identifier).toObject().value(fileName).toString();
+
+        if (hash != "" && QFile(localFile).exists() && hashFile(localFile) == hash) {
+            skipped++;
+            continue;
+        }
+
+        QDir(getCacheLocation()).mkpath(identifier);
+
+        if (!entry.open(QIODevice::ReadOnly))
+            continue;
+
+        QSaveFile file(localFile);
+
+        if (file.open(QIODevice::WriteOnly)) {
+            while (!entry.atEnd())
+                file.write(entry.read(64 * 1024));
+        }
+
+        entry.close();
+
+        if (entry.getZipError() != UNZ_OK || !file.commit())
+            continue;
+
+        imported++;
+
+        //A game only has one cover, drop the other format once the new one is safely written
+        if (fileName.startsWith("boxart-front.")) {
+            QString coverFile = getCacheLocation() + identifier + "/boxart-front.";
+
+            if (fileName != "boxart-front.jpg")
+                QFile::remove(coverFile + "jpg");
+            if (fileName != "boxart-front.png")
+                QFile::remove(coverFile + "png");
+        }
+    }
+
+    zip.close();
+    QApplication::restoreOverrideCursor();
+
+    QMessageBox::information(parent, title,
+                             tr("Imported %1 files, %2 were already up to date.").arg(imported).arg(skipped));
+}
@@ -32,14 +32,18 @@
 #include "logdialog.h"
 
 #include "../global.h"
+#include "../emulation/emulatorlog.h"
 
 #include <QDialogButtonBox>
 #include <QFontDatabase>
 #include <QGridLayout>
-#include <QTextEdit>
+#include <QLineEdit>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QScrollBar>
 
 
-LogDialog::LogDialog(QString lastOutput, QWidget *parent) : QDialog(parent)
+LogDialog::LogDialog(EmulatorLog *log, QWidget *parent) : QDialog(parent)
 {
     setWindowTitle(tr("<ParentName> Log").replace("<ParentName>",ParentName));
     setMinimumSize(600, 400);
@@ -47,21 +51,86 @@ LogDialog::LogDialog(QString lastOutput, QWidget *parent) : QDialog(parent)
     logLayout = new QGridLayout(this);
     logLayout->setContentsMargins(5, 10, 5, 10);
 
-    logArea = new QTextEdit(this);
+    logArea = new QPlainTextEdit(this);
+    logArea->setReadOnly(true);
     logArea->setWordWrapMode(QTextOption::NoWrap);
 
     QFont font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
     logArea->setFont(font);
 
-    logArea->setPlainText(lastOutput);
+    //The log is already bounded, keep the view to the same size while it tails
+    logArea->setMaximumBlockCount(log->getMaxLines() + 1);
+    logArea->setPlainText(log->getText());
+    logArea->verticalScrollBar()->setValue(logArea->verticalScrollBar()->maximum());
+
+    searchEdit = new QLineEdit(this);
+    searchEdit->setPlaceholderText(tr("Search"));
+
+    previousButton = new QPushButton(tr("&Previous"), this);
+    nextButton = new QPushButton(tr("&Next"), this);
 
     logButtonBox = new QDialogButtonBox(Qt::Horizontal, this);
     logButtonBox->addButton(tr("Close"), QDialogButtonBox::AcceptRole);
 
-    logLayout->addWidget(logArea, 0, 0);
-    logLayout->addWidget(logButtonBox, 1, 0);
+    logLayout->addWidget(logArea, 0, 0, 1, 3);
+    logLayout->addWidget(searchEdit, 1, 0);
+    logLayout->addWidget(previousButton, 1, 1);
+    logLayout->addWidget(nextButton, 1, 2);
+    logLayout->addWidget(logButtonBox, 2, 0, 1, 3);
 
+    connect(log, SIGNAL(appended(QString)), this, SLOT(appendLines(QString)));
+    connect(searchEdit, SIGNAL(returnPressed()), this, SLOT(findNext()));
+    connect(nextButton, SIGNAL(clicked()), this, SLOT(findNext()));
+    connect(previousButton, SIGNAL(clicked()), this, SLOT(findPrevious()));
     connect(logButtonBox, SIGNAL(accepted()), this, SLOT(close()));
 
     setLayout(logLayout);
 }
+
+
+void LogDialog::appendLines(QString lines)
+{
+    //Follow new output only when already at the end, so reading further up isn't interrupted
+    QScrollBar *scrollBar = logArea->verticalScrollBar();
+    bool tailing = scrollBar->value() == scrollBar->maximum();
+
+    logArea->appendPlainText(lines);
+
+    if (tailing)
+        scrollBar->setValue(scrollBar->maximum());
+}
+
+
+void LogDialog::find(bool backward)
+{
+    QString text = searchEdit->text();
+
+    if (text == "")
+        return;
+
+    QTextDocument::FindFlags flags;
+    if (backward)
+        flags |= QTextDocument::FindBackward;
+
+    if (logArea->find(text, flags))
+        return;
+
+    //Wrap around from the other end
+    QTextCursor cursor = logArea->textCursor();
+    cursor.movePosition(backward ? QTextCursor::End : QTextCursor::Start);
+    logArea->setTextCursor(cursor);
+
+    logArea->find(text, flags);
+}
+
+
+void LogDialog::findNext()
+{
+    find(false);
+}
+
+
+void LogDialog::findPrevious()
+{
+    find(true);
+}
@@ -36,19 +36,32 @@
 
 class QDialogButtonBox;
 class QGridLayout;
-class QTextEdit;
+class QLineEdit;
+class QPlainTextEdit;
+class QPushButton;
+class EmulatorLog;
 
 
 class LogDialog : public QDialog
 {
     Q_OBJECT
 public:
-    explicit LogDialog(QString lastOutput, QWidget *parent = 0);
+    explicit LogDialog(EmulatorLog *log, QWidget *parent = 0);
 
 private:
+    void find(bool backward);
+
     QDialogButtonBox *logButtonBox;
     QGridLayout *logLayout;
-    QTextEdit *logArea;
+    QLineEdit *searchEdit;
+    QPlainTextEdit *logArea;
+    QPushButton *nextButton;
+    QPushButton *previousButton;
+
+private slots:
+    void appendLines(QString lines);
+    void findNext();
+    void findPrevious();
 };
 
 #endif // LOGDIALOG_H
@@ -57,6 +57,12 @@ SettingsDialog::SettingsDialog(QWidget *parent, int activeTab) : QDialog(parent)
     foreach (QString directory, romDirectories)
         ui->romList->addItem(directory);
 
+    ui->scanDepthBox->setValue(SETTINGS.value("Paths/scandepth", -1).toInt());
+    ui->scanExcludeLine->setText(SETTINGS.value("Paths/scanexclude", "").toString());
+
+    if (SETTINGS.value("Paths/followsymlinks", "").toString() == "true")
+        ui->followSymlinksOption->setChecked(true);
+
     ui->savesPath->setText(SETTINGS.value("Saves/directory", "").toString());
     ui->eeprom4kPath->setText(SETTINGS.value("Saves/eeprom4k", "").toString());
     ui->eeprom16kPath->setText(SETTINGS.value("Saves/eeprom16k", "").toString());
@@ -110,6 +116,8 @@ SettingsDialog::SettingsDialog(QWidget *parent, int activeTab) : QDialog(parent)
     if (SETTINGS.value("Emulation/novideo", "").toString() == "true")
         ui->noVideoOption->setChecked(true);
 
+    ui->sessionsBox->setValue(SETTINGS.value("Emulation/sessions", 1).toInt());
+
 
     //Populate Controllers tab
     ctrlEnabled << ui->ctrl1Enabled
@@ -416,6 +424,9 @@ SettingsDialog::SettingsDialog(QWidget *parent, int activeTab) : QDialog(parent)
 
     ui->parametersLine->setText(SETTINGS.value("Other/parameters", "").toString());
 
+    if (SETTINGS.value("Other/prefetch", "").toString() == "true")
+        ui->prefetchOption->setChecked(true);
+
     for (int i = 0; i < languages.length(); i++)
     {
         ui->languageBox->insertItem(i, languages.at(i).at(0), languages.at(i).at(1));
@@ -605,6 +616,13 @@ void SettingsDialog::editSettings()
         romDirectories << item->text();
 
     SETTINGS.setValue("Paths/roms", romDirectories.join("|"));
+    SETTINGS.setValue("Paths/scandepth", ui->scanDepthBox->value());
+    SETTINGS.setValue("Paths/scanexclude", ui->scanExcludeLine->text());
+
+    if (ui->followSymlinksOption->isChecked())
+        SETTINGS.setValue("Paths/followsymlinks", true);
+    else
+        SETTINGS.setValue("Paths/followsymlinks", "");
 
     if (ui->saveOption->isChecked())
         SETTINGS.setValue("Saves/individualsave", true);
@@ -628,6 +646,8 @@ void SettingsDialog::editSettings()
     else
         SETTINGS.setValue("Emulation/novideo", "");
 
+    SETTINGS.setValue("Emulation/sessions", ui->sessionsBox->value());
+
 
     //Controllers tab
     for (int i = 0; i <= 3; i++)
@@ -730,6 +750,12 @@ void SettingsDialog::editSettings()
 #endif
 
     SETTINGS.setValue("Other/parameters", ui->parametersLine->text());
+
+    if (ui->prefetchOption->isChecked())
+        SETTINGS.setValue("Other/prefetch", true);
+    else
+        SETTINGS.setValue("Other/prefetch", "");
+
     SETTINGS.setValue("language", ui->languageBox->itemData(ui->languageBox->currentIndex()));
 
     close();
@@ -788,7 +814,9 @@ void SettingsDialog::populateAvailable(bool downloadItems) {
               << "CRC2"
               << "Players"
               << "Rumble"
-              << "Save Type";
+              << "Save Type"
+              << "Last Played"
+              << "Times Played";
 
     labelOptions << "Filename"
                  << "Filename (extension)"
@@ -798,7 +826,9 @@ void SettingsDialog::populateAvailable(bool downloadItems) {
     sortOptions << "Filename"
                 << "GoodName"
                 << "Internal Name"
-                << "Size";
+                << "Size"
+                << "Last Played"
+                << "Times Played";
 
     if (downloadItems) {
         available << "Game Title"
@@ -0,0 +1,566 @@
+/***
+ * Copyright (c) 2013, Dan Hasting
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "emulatorbenchmark.h"
+#include "emulatorhandler.h"
+#include "emulatorprocess.h"
+#include "telemetry.h"
+
+#include "../global.h"
+#include "../common.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegExp>
+#include <QSaveFile>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+
+#include <cmath>
+
+
+EmulatorBenchmark::EmulatorBenchmark(QString romPattern, int duration, int cores, QString outputFile,
+                                     QString emulatorPath, QString comparePath, int repeats,
+                                     QObject *parent) : QObject(parent)
+{
+    this->duration = qMax(1, duration);
+    this->outputFile = outputFile;
+
+    if (emulatorPath == "")
+        emulatorPath = SETTINGS.value("Paths/cen64", "").toString();
+
+    emulators << emulatorPath;
+    if (comparePath != "")
+        emulators << comparePath;
+
+    //A comparison needs a spread on both sides to say anything about the difference
+    if (repeats <= 0)
+        repeats = emulators.size() > 1 ? 5 : 1;
+
+    this->repeats = repeats;
+
+    if (cores <= 0)
+        cores = qMax(1, QThread::idealThreadCount());
+
+    //With -multithread each instance keeps two cores busy, so fewer fit in the budget
+    int coresPerRun = 1;
+    if (SETTINGS.value("Emulation/multithread", "").toString() == "true")
+        coresPerRun = 2;
+
+    jobs = qMax(1, cores / coresPerRun);
+    next = 0;
+    failed = 0;
+
+    roms = getRoms(romPattern);
+
+    //Rounds go over every ROM before repeating, and the builds swap order each time (ABBA),
+    //so heat building up over the session is spread evenly over both
+    for (int repeat = 0; repeat < this->repeats; repeat++)
+    {
+        for (int rom = 0; rom < roms.size(); rom++)
+        {
+            for (int i = 0; i < emulators.size(); i++)
+            {
+                BenchmarkRun run;
+                run.rom = rom;
+                run.build = (repeat + rom) % 2 == 0 ? i : emulators.size() - 1 - i;
+                run.repeat = repeat;
+
+                queue << run;
+                results << QJsonObject();
+            }
+        }
+    }
+
+    QTimer::singleShot(0, this, SLOT(start()));
+}
+
+
+QString EmulatorBenchmark::getCSVComparison(QJsonArray comparison)
+{
+    QString report = "rom,md5,runs_a,runs_b";
+    QStringList keys, values;
+    keys << "vi" << "mhz";
+    values << "a" << "b" << "delta_pct" << "ci95_pct";
+
+    foreach (QString key, keys)
+        foreach (QString value, values)
+            report += "," + key + "_" + value;
+
+    report += "\n";
+
+    foreach (QJsonValue row, comparison)
+    {
+        QJsonObject result = row.toObject();
+        QString rom = result.value("rom").toString();
+
+        if (rom.contains(",") || rom.contains("\""))
+            rom = "\"" + rom.replace("\"", "\"\"") + "\"";
+
+        report += rom + ","
+                + result.value("md5").toString() + ","
+                + QString::number(result.value("runs_a").toInt()) + ","
+                + QString::number(result.value("runs_b").toInt());
+
+        foreach (QString key, keys)
+        {
+            QJsonObject delta = result.value(key).toObject();
+
+            foreach (QString value, values)
+            {
+                report += ",";
+                if (delta.contains(value))
+                    report += QString::number(delta.value(value).toDouble(), 'f', 2);
+            }
+        }
+
+        report += "\n";
+    }
+
+    return report;
+}
+
+
+QString EmulatorBenchmark::getCSVReport()
+{
+    QString report = "rom,md5,build,repeat,status,samples";
+    QStringList keys, statistics;
+    keys << "vi" << "mhz";
+    statistics << "min" << "mean" << "p1" << "p99";
+
+    foreach (QString key, keys)
+        foreach (QString statistic, statistics)
+            report += "," + key + "_" + statistic;
+
+    report += "\n";
+
+    foreach (QJsonValue value, results)
+    {
+        QJsonObject result = value.toObject();
+        QString rom = result.value("rom").toString();
+
+        //Quote names that contain separators, quotes are doubled per RFC 4180
+        if (rom.contains(",") || rom.contains("\""))
+            rom = "\"" + rom.replace("\"", "\"\"") + "\"";
+
+        report += rom + ","
+                + result.value("md5").toString() + ","
+                + result.value("build").toString() + ","
+                + QString::number(result.value("repeat").toInt()) + ","
+                + result.value("status").toString() + ","
+                + QString::number(result.value("samples").toInt());
+
+        foreach (QString key, keys)
+        {
+            QJsonObject values = result.value(key).toObject();
+
+            foreach (QString statistic, statistics)
+            {
+                report += ",";
+                if (values.contains(statistic))
+                    report += QString::number(values.value(statistic).toDouble(), 'f', 2);
+            }
+        }
+
+        report += "\n";
+    }
+
+    return report;
+}
+
+
+QJsonArray EmulatorBenchmark::getComparison()
+{
+    QJsonArray comparison;
+
+    for (int rom = 0; rom < roms.size(); rom++)
+    {
+        QVector<double> viA, viB, mhzA, mhzB;
+
+        for (int i = 0; i < queue.size(); i++)
+        {
+            QJsonObject result = results.at(i).toObject();
+
+            if (queue.at(i).rom != rom || result.value("status").toString() != "ok")
+                continue;
+
+            double vi = result.value("vi").toObject().value("mean").toDouble();
+            double mhz = result.value("mhz").toObject().value("mean").toDouble();
+
+            if (queue.at(i).build == 0) {
+                viA << vi;
+                mhzA << mhz;
+            } else {
+                viB << vi;
+                mhzB << mhz;
+            }
+        }
+
+        QJsonObject row;
+        row.insert("rom", roms.at(rom).internalName != "" ? roms.at(rom).internalName : roms.at(rom).fileName);
+        row.insert("md5", roms.at(rom).md5);
+        row.insert("runs_a", viA.size());
+        row.insert("runs_b", viB.size());
+        row.insert("vi", getDelta(viA, viB));
+        row.insert("mhz", getDelta(mhzA, mhzB));
+
+        comparison << row;
+    }
+
+    return comparison;
+}
+
+
+QJsonObject EmulatorBenchmark::getDelta(QVector<double> valuesA, QVector<double> valuesB)
+{
+    QJsonObject delta;
+
+    if (valuesA.isEmpty() || valuesB.isEmpty())
+        return delta;
+
+    QList<QVector<double> > sides;
+    sides << valuesA << valuesB;
+    double mean[2], variance[2];
+
+    for (int side = 0; side < 2; side++)
+    {
+        double total = 0;
+        foreach (double value, sides.at(side))
+            total += value;
+        mean[side] = total / sides.at(side).size();
+
+        double squares = 0;
+        foreach (double value, sides.at(side))
+            squares += (value - mean[side]) * (value - mean[side]);
+        variance[side] = sides.at(side).size() > 1 ? squares / (sides.at(side).size() - 1) : 0;
+    }
+
+    delta.insert("a", mean[0]);
+    delta.insert("b", mean[1]);
+
+    if (mean[0] == 0)
+        return delta;
+
+    delta.insert("delta_pct", (mean[1] - mean[0]) / mean[0] * 100);
+
+    //Welch's interval on the difference of means, it doesn't assume both builds are equally noisy
+    if (valuesA.size() < 2 || valuesB.size() < 2)
+        return delta;
+
+    double errorA = variance[0] / valuesA.size();
+    double errorB = variance[1] / valuesB.size();
+    double error = std::sqrt(errorA + errorB);
+    double interval = 0;
+
+    if (error > 0) {
+        double degrees = (errorA + errorB) * (errorA + errorB)
+                / (errorA * errorA / (valuesA.size() - 1) + errorB * errorB / (valuesB.size() - 1));
+        interval = getTValue(degrees) * error;
+    }
+
+    delta.insert("ci95_pct", interval / mean[0] * 100);
+
+    return delta;
+}
+
+
+QString EmulatorBenchmark::getRomPath(int index)
+{
+    BenchmarkRom rom = roms.at(queue.at(index).rom);
+    QDir romDir(rom.directory);
+
+    if (rom.zipFile == "")
+        return romDir.absoluteFilePath(rom.fileName);
+
+    //Each run gets its own copy so parallel instances never share a temp file
+    QString romPath = tempDir.path() + "/" + QString::number(index) + ".z64";
+    QByteArray *romData = getZippedRom(rom.fileName, romDir.absoluteFilePath(rom.zipFile));
+
+    QFile tempRom(romPath);
+    tempRom.open(QIODevice::WriteOnly);
+    tempRom.write(*romData);
+    tempRom.close();
+
+    delete romData;
+
+    return romPath;
+}
+
+
+QList<BenchmarkRom> EmulatorBenchmark::getRoms(QString romPattern)
+{
+    QList<BenchmarkRom> found;
+    QRegExp pattern(romPattern == "" ? "*" : romPattern, Qt::CaseInsensitive, QRegExp::Wildcard);
+
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", "benchmark");
+        database.setDatabaseName(getDataLocation() + "/"+AppNameLower+".sqlite");
+        database.open();
+
+        //64DD disks need the IPL and a matching cartridge, so only cartridges are benchmarked
+        QSqlQuery query(QString("SELECT filename, directory, md5, internal_name, zip_file ")
+                        + "FROM rom_collection WHERE dd_rom = 0 ORDER BY filename", database);
+
+        while (query.next())
+        {
+            BenchmarkRom rom;
+            rom.fileName = query.value(0).toString();
+            rom.directory = query.value(1).toString();
+            rom.md5 = query.value(2).toString();
+            rom.internalName = query.value(3).toString();
+            rom.zipFile = query.value(4).toString();
+
+            if (pattern.exactMatch(rom.fileName) || pattern.exactMatch(rom.internalName)
+                    || (rom.zipFile != "" && pattern.exactMatch(rom.zipFile)))
+                found << rom;
+        }
+
+        query.finish();
+        database.close();
+    }
+
+    QSqlDatabase::removeDatabase("benchmark");
+
+    return found;
+}
+
+
+double EmulatorBenchmark::getTValue(double degrees)
+{
+    //Two-sided 95% critical values of Student's t, the normal value is close enough past 30
+    static const double table[] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+
+    int index = qMax(1, int(degrees)) - 1;
+
+    if (index >= int(sizeof(table) / sizeof(table[0])))
+        return 1.96;
+
+    return table[index];
+}
+
+
+void EmulatorBenchmark::readOutput()
+{
+    QProcess *process = qobject_cast<QProcess*>(sender());
+
+    if (process && runs.contains(process))
+        runs.value(process)->addOutput(process->readAllStandardOutput());
+}
+
+
+void EmulatorBenchmark::runError(QProcess::ProcessError error)
+{
+    //Processes that never started don't emit finished(), so handle them the same way here
+    if (error == QProcess::FailedToStart)
+        runFinished();
+}
+
+
+void EmulatorBenchmark::runFinished()
+{
+    QProcess *process = qobject_cast<QProcess*>(sender());
+
+    if (!process || !runs.contains(process))
+        return;
+
+    int index = process->property("index").toInt();
+    BenchmarkRun run = queue.at(index);
+    BenchmarkRom rom = roms.at(run.rom);
+
+    Telemetry *telemetry = runs.take(process);
+    telemetry->addOutput(process->readAllStandardOutput() + "\n");
+
+    QJsonObject result = telemetry->finish();
+    result.insert("rom", rom.internalName != "" ? rom.internalName : rom.fileName);
+    result.insert("file", rom.fileName);
+    result.insert("md5", rom.md5);
+    result.insert("build", QString(QChar('a' + run.build)));
+    result.insert("repeat", run.repeat + 1);
+
+    //Being stopped at the end of the duration is the expected way out, no samples means it never ran
+    if (process->error() == QProcess::FailedToStart)
+        result.insert("status", "failed to start");
+    else if (result.value("samples").toInt() == 0)
+        result.insert("status", "no samples");
+    else
+        result.insert("status", "ok");
+
+    if (result.value("status").toString() != "ok")
+        failed++;
+
+    results[index] = result;
+
+    QTextStream(stderr) << "[" << index + 1 << "/" << queue.size() << "] "
+                        << result.value("rom").toString()
+                        << (emulators.size() > 1 ? " (" + result.value("build").toString() + ")" : QString())
+                        << ": "
+                        << (result.value("status").toString() == "ok"
+                            ? QString::number(result.value("vi").toObject().value("mean").toDouble(), 'f', 2)
+                              + " VI/s, "
+                              + QString::number(result.value("mhz").toObject().value("mean").toDouble(), 'f', 2)
+                              + " MHz"
+                            : result.value("status").toString())
+                        << "\n";
+
+    if (rom.zipFile != "")
+        QFile::remove(tempDir.path() + "/" + QString::number(index) + ".z64");
+
+    process->deleteLater();
+
+    if (next < queue.size())
+        startRun(next++);
+    else if (runs.isEmpty()) {
+        writeReport();
+        QCoreApplication::exit(failed == 0 ? 0 : 1);
+    }
+}
+
+
+void EmulatorBenchmark::start()
+{
+    QTextStream err(stderr);
+    QFileInfo pifFile(SETTINGS.value("Paths/pifrom", "").toString());
+
+    foreach (QString emulatorPath, emulators)
+    {
+        QFileInfo emulatorFile(emulatorPath);
+
+        if (!emulatorFile.exists() || emulatorFile.isDir() || !emulatorFile.isExecutable()) {
+            err << ParentName << " executable not found: " << emulatorPath << "\n";
+            QCoreApplication::exit(1);
+            return;
+        }
+    }
+
+    if (!pifFile.exists() || pifFile.isDir()) {
+        err << "PIF IPL file not found.\n";
+        QCoreApplication::exit(1);
+        return;
+    }
+
+    if (roms.isEmpty()) {
+        err << "No ROMs in the collection match.\n";
+        QCoreApplication::exit(1);
+        return;
+    }
+
+    err << "Benchmarking " << roms.size() << " ROMs for " << duration << " s each";
+    if (emulators.size() > 1)
+        err << ", " << repeats << " runs per build";
+    else if (repeats > 1)
+        err << ", " << repeats << " runs each";
+    err << ", " << qMin(jobs, queue.size()) << " at a time\n";
+
+    while (next < queue.size() && runs.size() < jobs)
+        startRun(next++);
+}
+
+
+void EmulatorBenchmark::startRun(int index)
+{
+    QString emulatorPath = emulators.at(queue.at(index).build);
+
+    QProcess *process = new EmulatorProcess(this);
+    process->setProperty("index", index);
+    process->setProcessChannelMode(QProcess::MergedChannels);
+
+    Telemetry *telemetry = new Telemetry(process);
+    runs.insert(process, telemetry);
+
+    connect(process, SIGNAL(readyReadStandardOutput()), this, SLOT(readOutput()));
+    connect(process, SIGNAL(finished(int)), this, SLOT(runFinished()));
+#if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+    connect(process, SIGNAL(errorOccurred(QProcess::ProcessError)), this, SLOT(runError(QProcess::ProcessError)));
+#else
+    connect(process, SIGNAL(error(QProcess::ProcessError)), this, SLOT(runError(QProcess::ProcessError)));
+#endif
+
+    //Ask nicely at the end of the duration, and kill it if it hasn't gone a few seconds later
+    QTimer::singleShot(duration * 1000, process, SLOT(terminate()));
+    QTimer::singleShot(duration * 1000 + 5000, process, SLOT(kill()));
+
+    //Both builds get the arguments a real launch would, only the executable differs. A fixed run
+    //without video isn't play, so it's kept out of the ROM's history and only goes in the results
+    telemetry->start(roms.at(queue.at(index).rom).md5, emulatorPath, false);
+    process->start(emulatorPath, EmulatorHandler::getEmulatorArgs(getRomPath(index), "", true));
+}
+
+
+void EmulatorBenchmark::writeReport()
+{
+    QString report;
+    QJsonArray comparison;
+
+    if (emulators.size() > 1)
+        comparison = getComparison();
+
+    if (outputFile.endsWith(".json", Qt::CaseInsensitive)) {
+        QJsonObject json;
+        json.insert("date", QDateTime::currentDateTime().toString(Qt::ISODate));
+        json.insert("emulator", emulators.first());
+        if (emulators.size() > 1)
+            json.insert("compare", emulators.last());
+        json.insert("duration", duration);
+        json.insert("repeats", repeats);
+        json.insert("jobs", jobs);
+        json.insert("results", results);
+        if (emulators.size() > 1)
+            json.insert("comparison", comparison);
+
+        report = QJsonDocument(json).toJson();
+    } else if (emulators.size() > 1)
+        report = getCSVComparison(comparison);
+    else
+        report = getCSVReport();
+
+    if (outputFile == "") {
+        QTextStream(stdout) << report;
+        return;
+    }
+
+    QSaveFile file(outputFile);
+
+    if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        file.write(report.toUtf8());
+        file.commit();
+    } else
+        QTextStream(stderr) << "Could not write " << outputFile << "\n";
+}
@@ -0,0 +1,101 @@
+/***
+ * Copyright (c) 2013, Dan Hasting
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#ifndef EMULATORBENCHMARK_H
+#define EMULATORBENCHMARK_H
+
+#include <QHash>
+#include <QJsonArray>
+#include <QObject>
+#include <QProcess>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QVector>
+
+class Telemetry;
+
+
+struct BenchmarkRom {
+    QString fileName;
+    QString directory;
+    QString md5;
+    QString internalName;
+    QString zipFile;
+};
+
+
+struct BenchmarkRun {
+    int rom;
+    int build;
+    int repeat;
+};
+
+
+class EmulatorBenchmark : public QObject
+{
+    Q_OBJECT
+public:
+    explicit EmulatorBenchmark(QString romPattern = "", int duration = 30, int cores = 0,
+                               QString outputFile = "", QString emulatorPath = "", QString comparePath = "",
+                               int repeats = 0, QObject *parent = 0);
+
+private:
+    QString getCSVComparison(QJsonArray comparison);
+    QString getCSVReport();
+    QJsonArray getComparison();
+    QJsonObject getDelta(QVector<double> valuesA, QVector<double> valuesB);
+    QString getRomPath(int index);
+    QList<BenchmarkRom> getRoms(QString romPattern);
+    double getTValue(double degrees);
+    void startRun(int index);
+    void writeReport();
+
+    int duration;
+    int jobs;
+    int next;
+    int failed;
+    int repeats;
+    QString outputFile;
+    QStringList emulators;
+    QTemporaryDir tempDir;
+    QList<BenchmarkRom> roms;
+    QList<BenchmarkRun> queue;
+    QJsonArray results;
+    QHash<QProcess*, Telemetry*> runs;
+
+private slots:
+    void readOutput();
+    void runError(QProcess::ProcessError error);
+    void runFinished();
+    void start();
+};
+
+#endif // EMULATORBENCHMARK_H
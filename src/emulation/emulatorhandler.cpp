@@ -30,14 +30,21 @@
  ***/
 
 #include "emulatorhandler.h"
+#include "emulatorlog.h"
+#include "emulatorsession.h"
+#include "romprefetcher.h"
 
 #include "../global.h"
 #include "../common.h"
+#include "../dialogs/logdialog.h"
 
 #include <QFile>
 #include <QMessageBox>
-#include <QProcess>
+#include <QPointer>
 #include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QSqlDatabase>
+#include <QSqlQuery>
 
 #include <quazip5/quazip.h>
 #include <quazip5/quazipfile.h>
@@ -47,38 +54,239 @@ EmulatorHandler::EmulatorHandler(QWidget *parent) : QObject(parent)
 {
     this->parent = parent;
 
-    lastOutput = "";
+    nextSession = 1;
+    lastLog = nullptr;
+    prefetcher = new RomPrefetcher(getTempDir(), this);
 }
 
-void EmulatorHandler::checkStatus(int status)
+
+void EmulatorHandler::cancelPrefetch()
+{
+    prefetcher->cancel();
+}
+
+
+void EmulatorHandler::checkStatus(int status, EmulatorLog *log)
 {
-    if (status > 0) {
+    if (status != 0) {
+        QString message = tr("<ParentName> quit unexpectedly. Check the log for more information.");
+
+        //Sessions report -1 when the process never started
+        if (status == -1)
+            message = tr("<ParentName> could not be started. Check the log for more information.");
+
         QMessageBox exitDialog(parent);
         exitDialog.setWindowTitle(tr("Warning"));
-        exitDialog.setText(tr("<ParentName> quit unexpectedly. Check the log for more information.")
-                           .replace("<ParentName>",ParentName));
+        exitDialog.setText(message.replace("<ParentName>",ParentName));
         exitDialog.setIcon(QMessageBox::Warning);
         exitDialog.addButton(QMessageBox::Ok);
         exitDialog.addButton(tr("View Log..."), QMessageBox::HelpRole);
 
+        //Other sessions may still be running, so show this one's log rather than the newest.
+        //Another one finishing while the dialog is open frees this log, hence the QPointer
+        QPointer<EmulatorLog> finishedLog(log);
         int ret = exitDialog.exec();
-        if (ret == 0) emit showLog();
+        if (ret == 0 && finishedLog) {
+            LogDialog logDialog(finishedLog, parent);
+            logDialog.exec();
+        }
     }
 
     updateStatus(tr("Emulation stopped"), 3000);
 }
 
 
-void EmulatorHandler::cleanTemp()
+void EmulatorHandler::cleanTemp(QStringList tempFiles)
 {
-    QFile::remove(QDir::tempPath() + "/" + AppNameLower + "-" + qgetenv("USER") + "/temp.bin");
-    QFile::remove(QDir::tempPath() + "/" + AppNameLower + "-" + qgetenv("USER") + "/64dd-temp.bin");
+    foreach (QString tempFile, tempFiles)
+    {
+        QFile::remove(tempFile);
+        QDir().rmdir(QFileInfo(tempFile).path());
+    }
 }
 
 
-void EmulatorHandler::emitFinished()
+QStringList EmulatorHandler::getEmulatorArgs(QString romPath, QString ddPath, bool headless,
+                                             QString romMD5, QString saveType)
 {
-    emit finished();
+    QString pifPath = SETTINGS.value("Paths/pifrom", "").toString();
+    QString ddIPLPath = SETTINGS.value("Paths/ddiplrom", "").toString();
+
+    bool ddMode = false;
+    if (SETTINGS.value("Emulation/64dd", "").toString() == "true")
+        ddMode = true;
+
+    QStringList args;
+
+    //Headless runs are for measuring, they shouldn't touch the player's saves or paks
+    if (!headless && SETTINGS.value("Saves/individualsave", "").toString() == "true") {
+        QString eeprom4kPath = SETTINGS.value("Saves/eeprom4k", "").toString();
+        QString eeprom16kPath = SETTINGS.value("Saves/eeprom16k", "").toString();
+        QString sramPath = SETTINGS.value("Saves/sram", "").toString();
+        QString flashPath = SETTINGS.value("Saves/flash", "").toString();
+
+        if (eeprom4kPath != "")
+            args << "-eep4k" << eeprom4kPath;
+        if (eeprom16kPath != "")
+            args << "-eep16k" << eeprom16kPath;
+        if (sramPath != "")
+            args << "-sram" << sramPath;
+        if (flashPath != "")
+            args << "-flash" << flashPath;
+    } else if (!headless) {
+        QString savesPath = SETTINGS.value("Saves/directory", "").toString();
+        if (savesPath != "") {
+            QDir savesDir(savesPath);
+
+            if (savesDir.exists()) {
+                //ROMs launched from the collection arrive with their MD5 and save type, only
+                //files opened from elsewhere need to be hashed and looked up here
+                bool catalogued = romMD5 != "";
+                if (catalogued)
+                    romMD5 = romMD5.toLower();
+                else
+                    romMD5 = getRomMD5(romPath);
+
+                QString romBaseName = QFileInfo(romPath).completeBaseName();
+                QString eeprom4kFileName = romBaseName + "." + romMD5 + ".eep4k";
+                QString eeprom16kFileName = romBaseName + "." + romMD5 + ".eep16k";
+                QString sramFileName = romBaseName + "." + romMD5 + ".sram";
+                QString flashFileName = romBaseName + "." + romMD5 + ".flash";
+                QString eeprom4kPath = savesDir.absoluteFilePath(eeprom4kFileName);
+                QString eeprom16kPath = savesDir.absoluteFilePath(eeprom16kFileName);
+                QString sramPath = savesDir.absoluteFilePath(sramFileName);
+                QString flashPath = savesDir.absoluteFilePath(flashFileName);
+
+                // Check ROM catalog to determine save type
+                QString catalogFile = SETTINGS.value("Paths/catalog", "").toString();
+                if (!catalogued && QFileInfo(catalogFile).exists()) {
+                    QSettings romCatalog(catalogFile, QSettings::IniFormat);
+                    saveType = romCatalog.value(romMD5.toUpper()+"/SaveType","").toString();
+                }
+
+                if (saveType == "Eeprom 4KB")
+                    args << "-eep4k"  << eeprom4kPath;
+                else if (saveType == "Eeprom 16KB")
+                    args << "-eep16k"  << eeprom16kPath;
+                else if (saveType == "SRAM")
+                    args << "-sram"  << sramPath;
+                else if (saveType == "Flash RAM")
+                    args << "-flash"  << flashPath;
+                else if (saveType == "Controller Pack");
+                else
+                    args << "-eep4k"  << eeprom4kPath
+                         << "-eep16k" << eeprom16kPath
+                         << "-sram"   << sramPath
+                         << "-flash"  << flashPath;
+            }
+        }
+    }
+
+    for (int i = 1; i <= 4 && !headless; i++)
+    {
+        QString ctrl = "Controller"+QString::number(i);
+
+        if (SETTINGS.value(ctrl+"/enabled", "").toString() == "true") {
+            args << "-controller";
+            QString options = "num="+QString::number(i);
+
+            int accessory = SETTINGS.value(ctrl+"/accessory", 0).toInt();
+            QString memPak = SETTINGS.value(ctrl+"/mempak", "").toString();
+            QString tPakROM = SETTINGS.value(ctrl+"/tpakrom", "").toString();
+            QString tPakSave = SETTINGS.value(ctrl+"/tpaksave", "").toString();
+
+            if (accessory == 1) //Rumble Pak
+                options += ",pak=rumble";
+            else if (accessory == 2 && memPak != "") //Controller Pak
+                options += ",mempak="+memPak;
+            else if (accessory == 3 && tPakROM != "" && tPakSave != "") //Transfer Pak
+                options += ",tpak_rom="+tPakROM+",tpak_save="+tPakSave;
+
+            args << options;
+        }
+    }
+
+    if (SETTINGS.value("Emulation/multithread", "").toString() == "true")
+        args << "-multithread";
+    if (headless || SETTINGS.value("Emulation/noaudio", "").toString() == "true")
+        args << "-noaudio";
+    if (headless || SETTINGS.value("Emulation/novideo", "").toString() == "true")
+        args << "-novideo";
+
+    if (ddIPLPath != "" && ddPath != "" && ddMode)
+        args << "-ddipl" << ddIPLPath << "-ddrom" << ddPath;
+
+    QString otherParameters = SETTINGS.value("Other/parameters", "").toString();
+    if (otherParameters != "")
+        args.append(parseArgString(otherParameters));
+
+    args << pifPath;
+
+    if (romPath != "")
+        args << romPath;
+
+    return args;
+}
+
+
+EmulatorLog *EmulatorHandler::getLog()
+{
+    //The newest running session, or the last one to finish
+    if (!sessions.isEmpty())
+        return sessions.last()->getLog();
+
+    return lastLog;
+}
+
+
+QString EmulatorHandler::getRomMD5(QString romPath)
+{
+    QFile romFile(romPath);
+
+    if (!romFile.open(QIODevice::ReadOnly))
+        return "";
+
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(&romFile);
+    romFile.close();
+
+    return QString(hash.result().toHex());
+}
+
+
+QList<EmulatorSession*> EmulatorHandler::getSessions()
+{
+    return sessions;
+}
+
+
+QString EmulatorHandler::getTempDir()
+{
+    return QDir::tempPath() + "/" + AppNameLower + "-" + qgetenv("USER");
+}
+
+
+bool EmulatorHandler::isFull()
+{
+    return sessions.size() >= qMax(1, SETTINGS.value("Emulation/sessions", 1).toInt());
+}
+
+
+bool EmulatorHandler::isRunning()
+{
+    return !sessions.isEmpty();
+}
+
+
+void EmulatorHandler::prefetchRom(QDir romDir, QString romFileName, QString zipFileName)
+{
+    if (SETTINGS.value("Other/prefetch", "").toString() != "true" || romFileName == "")
+        return;
+
+    if (zipFileName != "")
+        prefetcher->prefetch(romFileName, romDir.absoluteFilePath(zipFileName));
+    else
+        prefetcher->prefetch(romDir.absoluteFilePath(romFileName));
 }
 
 
@@ -121,25 +329,98 @@ QStringList EmulatorHandler::parseArgString(QString argString)
 }
 
 
-void EmulatorHandler::readOutput()
+void EmulatorHandler::saveHistory(EmulatorSession *session)
 {
-    QString output = emulatorProc->readAllStandardOutput();
-    QStringList outputList = output.split("\n");
+    QVariantMap record = session->getRecord();
 
-    int lastIndex = outputList.lastIndexOf(QRegExp("^.*VI/s.*MHz$"));
+    //A process that never started isn't a play
+    if (record.value("md5").toString() == "" || record.value("exit_code").toInt() == -1)
+        return;
 
-    if (lastIndex >= 0)
-        updateStatus(outputList[lastIndex]);
+    //Own connection, the default one is opened and closed by RomCollection around scans
+    QSqlDatabase database;
+    if (QSqlDatabase::contains("history"))
+        database = QSqlDatabase::database("history");
+    else {
+        database = QSqlDatabase::addDatabase("QSQLITE", "history");
+        database.setDatabaseName(getDataLocation() + "/"+AppNameLower+".sqlite");
+    }
+
+    if (!database.open())
+        return;
+
+    QStringList columns = record.keys();
 
-    lastOutput.append(output);
+    QSqlQuery query(database);
+    query.prepare("INSERT INTO play_sessions (" + columns.join(", ") + ") "
+                  + "VALUES (:" + columns.join(", :") + ")");
+
+    foreach (QString column, columns)
+        query.bindValue(":" + column, record.value(column));
+
+    if (query.exec())
+        emit historySaved(record.value("md5").toString(), record.value("ended").toLongLong());
+
+    query.finish();
+    database.close();
+}
+
+
+void EmulatorHandler::sessionFinished(int status)
+{
+    EmulatorSession *session = qobject_cast<EmulatorSession*>(sender());
+
+    if (!session)
+        return;
+
+    //The log outlives its session until the next one finishes
+    delete lastLog;
+    lastLog = session->getLog();
+    lastLog->setParent(this);
+
+    saveHistory(session);
+
+    sessions.removeAll(session);
+    session->deleteLater();
+
+    emit finished();
+    checkStatus(status, lastLog);
+}
+
+
+void EmulatorHandler::sessionStatus(QString message)
+{
+    EmulatorSession *session = qobject_cast<EmulatorSession*>(sender());
+
+    //Only one line fits in the status bar, so name the game when several are running
+    if (session && sessions.size() > 1)
+        message = session->getName() + ": " + message;
+
+    updateStatus(message);
 }
 
 
 void EmulatorHandler::startEmulator(QDir romDir, QString romFileName, QString zipFileName,
-                                    QDir ddDir, QString ddFileName, QString ddZipName)
+                                    QDir ddDir, QString ddFileName, QString ddZipName,
+                                    QString romMD5, QString saveType)
 {
+    //Each stage is timed and written to the session log so slow launches can be traced
+    QElapsedTimer launchTimer;
+    launchTimer.start();
+    QStringList stages;
+    qint64 stageStart = 0;
+
+    if (isFull()) {
+        QMessageBox::warning(parent, tr("Warning"),
+                             tr("The maximum number of <ParentName> sessions is already running.")
+                             .replace("<ParentName>",ParentName));
+        return;
+    }
+
     QString completeRomPath = "", complete64DDPath = "";
-    bool zip = false, ddZip = false;
+    QStringList tempFiles;
+    bool zip = false, ddZip = false, prefetched = false;
+    int sessionID = nextSession++;
 
     //If zipped file, extract and write to temp location for loading
     QStringList zippedFiles;
@@ -163,19 +444,35 @@ void EmulatorHandler::startEmulator(QDir romDir, QString romFileName, QString zi
                 zipFile = ddDir.absoluteFilePath(zippedFile);
             }
 
-            QByteArray *romData = getZippedRom(fileInZip, zipFile);
-
-            QString tempDir = QDir::tempPath() + "/" + AppNameLower + "-" + qgetenv("USER");
+            //Each session extracts to its own directory, the file name stays the same since
+            //zipped ROMs' save files are named after it
+            QString tempDir = getTempDir() + "/" + QString::number(sessionID);
             QDir().mkpath(tempDir);
 
             romPath = tempDir + tempName;
-            QFile tempRom(romPath);
 
-            tempRom.open(QIODevice::WriteOnly);
-            tempRom.write(*romData);
-            tempRom.close();
+            //A ROM extracted while it was highlighted only has to be moved into place
+            QString prefetchPath = !ddZipCheck ? prefetcher->takeExtracted(fileInZip, zipFile) : "";
 
-            delete romData;
+            if (prefetchPath != "" && QFile::rename(prefetchPath, romPath))
+                prefetched = true;
+            else {
+                QByteArray *romData = getZippedRom(fileInZip, zipFile);
+                QFile tempRom(romPath);
+
+                tempRom.open(QIODevice::WriteOnly);
+                tempRom.write(*romData);
+                tempRom.close();
+
+                delete romData;
+            }
+
+            if (prefetchPath != "") {
+                QFile::remove(prefetchPath);
+                QDir().rmdir(QFileInfo(prefetchPath).path());
+            }
+
+            tempFiles << romPath;
 
             if (!ddZipCheck)
                 completeRomPath = romPath;
@@ -186,6 +483,15 @@ void EmulatorHandler::startEmulator(QDir romDir, QString romFileName, QString zi
         ddZipCheck = true;
     }
 
+    //Anything still being prefetched would only compete with this launch for the disk
+    prefetcher->cancel();
+
+    if (zip || ddZip) {
+        stages << (prefetched ? tr("extract %1 ms (prefetched)") : tr("extract %1 ms"))
+                  .arg(launchTimer.elapsed() - stageStart);
+        stageStart = launchTimer.elapsed();
+    }
+
     if (zipFileName == "" && romFileName != "")
         completeRomPath = romDir.absoluteFilePath(romFileName);
     if (ddZipName == "" && ddFileName != "")
@@ -210,38 +516,38 @@ void EmulatorHandler::startEmulator(QDir romDir, QString romFileName, QString zi
     if (!emulatorFile.exists() || QFileInfo(emulatorFile).isDir() || !QFileInfo(emulatorFile).isExecutable()) {
         QMessageBox::warning(parent, tr("Warning"),
                              tr("<ParentName> executable not found.").replace("<ParentName>",ParentName));
-        if (zip || ddZip) cleanTemp();
+        if (zip || ddZip) cleanTemp(tempFiles);
         return;
     }
 
     if (!pifFile.exists() || QFileInfo(pifFile).isDir()) {
         QMessageBox::warning(parent, tr("Warning"), tr("PIF IPL file not found."));
-        if (zip || ddZip) cleanTemp();
+        if (zip || ddZip) cleanTemp(tempFiles);
         return;
     }
 
     if (ddIPLPath != "" && (!ddIPL.exists() || QFileInfo(ddIPL).isDir())) {
         QMessageBox::warning(parent, tr("Warning"), tr("64DD IPL file not found."));
-        if (zip || ddZip) cleanTemp();
+        if (zip || ddZip) cleanTemp(tempFiles);
         return;
     }
 
     if (completeRomPath != "" && (!romFile.exists() || QFileInfo(romFile).isDir())) {
         QMessageBox::warning(parent, tr("Warning"), tr("ROM file not found."));
-        if (zip || ddZip) cleanTemp();
+        if (zip || ddZip) cleanTemp(tempFiles);
         return;
     }
 
     if (completeRomPath == "" && complete64DDPath != ""
             && (!ddFile.exists() || QFileInfo(ddFile).isDir())) {
         QMessageBox::warning(parent, tr("Warning"), tr("64DD ROM file not found."));
-        if (zip || ddZip) cleanTemp();
+        if (zip || ddZip) cleanTemp(tempFiles);
         return;
     }
 
     if (completeRomPath == "" && complete64DDPath == "") {
         QMessageBox::warning(parent, tr("Warning"), tr("No ROM selected."));
-        if (zip || ddZip) cleanTemp();
+        if (zip || ddZip) cleanTemp(tempFiles);
         return;
     }
 
@@ -258,12 +564,12 @@ void EmulatorHandler::startEmulator(QDir romDir, QString romFileName, QString zi
                     completeRomPath = "";
                 } else {
                     QMessageBox::warning(parent, tr("Warning"), tr("64DD not enabled."));
-                    if (zip || ddZip) cleanTemp();
+                    if (zip || ddZip) cleanTemp(tempFiles);
                     return;
                 }
             } else {
                 QMessageBox::warning(parent, tr("Warning"), tr("Not a valid Z64 File."));
-                if (zip || ddZip) cleanTemp();
+                if (zip || ddZip) cleanTemp(tempFiles);
                 return;
             }
         }
@@ -276,177 +582,60 @@ void EmulatorHandler::startEmulator(QDir romDir, QString romFileName, QString zi
 
         if (romCheck.toHex() != "e848d316") {
             QMessageBox::warning(parent, tr("Warning"), tr("Not a valid 64DD File."));
-            if (zip || ddZip) cleanTemp();
+            if (zip || ddZip) cleanTemp(tempFiles);
             return;
         }
     }
 
 
-    QStringList args;
-
-    if (SETTINGS.value("Saves/individualsave", "").toString() == "true") {
-        QString eeprom4kPath = SETTINGS.value("Saves/eeprom4k", "").toString();
-        QString eeprom16kPath = SETTINGS.value("Saves/eeprom16k", "").toString();
-        QString sramPath = SETTINGS.value("Saves/sram", "").toString();
-        QString flashPath = SETTINGS.value("Saves/flash", "").toString();
-
-        if (eeprom4kPath != "")
-            args << "-eep4k" << eeprom4kPath;
-        if (eeprom16kPath != "")
-            args << "-eep16k" << eeprom16kPath;
-        if (sramPath != "")
-            args << "-sram" << sramPath;
-        if (flashPath != "")
-            args << "-flash" << flashPath;
-    } else {
-        QString savesPath = SETTINGS.value("Saves/directory", "").toString();
-        if (savesPath != "") {
-            QDir savesDir(savesPath);
-
-            if (savesDir.exists()) {
-                romFile.open(QIODevice::ReadOnly);
-                QByteArray *romData = new QByteArray(romFile.readAll());
-                romFile.close();
-
-                QString romMD5 = QString(QCryptographicHash::hash(*romData,
-                                                                  QCryptographicHash::Md5).toHex());
-
-                QString romBaseName = QFileInfo(romFile).completeBaseName();
-                QString eeprom4kFileName = romBaseName + "." + romMD5 + ".eep4k";
-                QString eeprom16kFileName = romBaseName + "." + romMD5 + ".eep16k";
-                QString sramFileName = romBaseName + "." + romMD5 + ".sram";
-                QString flashFileName = romBaseName + "." + romMD5 + ".flash";
-                QString eeprom4kPath = savesDir.absoluteFilePath(eeprom4kFileName);
-                QString eeprom16kPath = savesDir.absoluteFilePath(eeprom16kFileName);
-                QString sramPath = savesDir.absoluteFilePath(sramFileName);
-                QString flashPath = savesDir.absoluteFilePath(flashFileName);
-
-                // Check ROM catalog to determine save type
-                QString catalogFile = SETTINGS.value("Paths/catalog", "").toString();
-                if (QFileInfo(catalogFile).exists()) {
-                    QSettings romCatalog(catalogFile, QSettings::IniFormat, parent);
-                    QString saveType = romCatalog.value(romMD5.toUpper()+"/SaveType","").toString();
-
-                    if (saveType == "Eeprom 4KB")
-                        args << "-eep4k"  << eeprom4kPath;
-                    else if (saveType == "Eeprom 16KB")
-                        args << "-eep16k"  << eeprom16kPath;
-                    else if (saveType == "SRAM")
-                        args << "-sram"  << sramPath;
-                    else if (saveType == "Flash RAM")
-                        args << "-flash"  << flashPath;
-                    else if (saveType == "Controller Pack");
-                    else
-                        args << "-eep4k"  << eeprom4kPath
-                             << "-eep16k" << eeprom16kPath
-                             << "-sram"   << sramPath
-                             << "-flash"  << flashPath;
-                } else {
-                    args << "-eep4k"  << eeprom4kPath
-                         << "-eep16k" << eeprom16kPath
-                         << "-sram"   << sramPath
-                         << "-flash"  << flashPath;
-                }
-
-                delete romData;
-            }
-        }
-    }
-
-    for (int i = 1; i <= 4; i++)
-    {
-        QString ctrl = "Controller"+QString::number(i);
-
-        if (SETTINGS.value(ctrl+"/enabled", "").toString() == "true") {
-            args << "-controller";
-            QString options = "num="+QString::number(i);
-
-            int accessory = SETTINGS.value(ctrl+"/accessory", 0).toInt();
-            QString memPak = SETTINGS.value(ctrl+"/mempak", "").toString();
-            QString tPakROM = SETTINGS.value(ctrl+"/tpakrom", "").toString();
-            QString tPakSave = SETTINGS.value(ctrl+"/tpaksave", "").toString();
-
-            if (accessory == 1) //Rumble Pak
-                options += ",pak=rumble";
-            else if (accessory == 2 && memPak != "") //Controller Pak
-                options += ",mempak="+memPak;
-            else if (accessory == 3 && tPakROM != "" && tPakSave != "") //Transfer Pak
-                options += ",tpak_rom="+tPakROM+",tpak_save="+tPakSave;
-
-            args << options;
-        }
-    }
-
-    if (SETTINGS.value("Emulation/multithread", "").toString() == "true")
-        args << "-multithread";
-    if (SETTINGS.value("Emulation/noaudio", "").toString() == "true")
-        args << "-noaudio";
-    if (SETTINGS.value("Emulation/novideo", "").toString() == "true")
-        args << "-novideo";
-
-    if (ddIPLPath != "" && complete64DDPath != "" && ddMode)
-        args << "-ddipl" << ddIPLPath << "-ddrom" << complete64DDPath;
-    else if (completeRomPath == "") {
+    if (completeRomPath == "" && (ddIPLPath == "" || complete64DDPath == "" || !ddMode)) {
         QMessageBox::warning(parent, tr("Warning"), tr("No ROM selected or 64DD not enabled."));
-        if (zip || ddZip) cleanTemp();
+        if (zip || ddZip) cleanTemp(tempFiles);
         return;
     }
 
-    QString otherParameters = SETTINGS.value("Other/parameters", "").toString();
-    if (otherParameters != "")
-        args.append(parseArgString(otherParameters));
-
-    args << pifPath;
+    stages << tr("checks %1 ms").arg(launchTimer.elapsed() - stageStart);
+    stageStart = launchTimer.elapsed();
 
+    //A 64DD disk picked up as the ROM isn't the cartridge the collection described
+    QStringList args;
     if (completeRomPath != "")
-        args << completeRomPath;
-
-    emulatorProc = new QProcess(this);
-    connect(emulatorProc, SIGNAL(finished(int)), this, SLOT(emitFinished()));
-    connect(emulatorProc, SIGNAL(finished(int)), this, SLOT(checkStatus(int)));
+        args = getEmulatorArgs(completeRomPath, complete64DDPath, false, romMD5, saveType);
+    else
+        args = getEmulatorArgs(completeRomPath, complete64DDPath);
 
-    if (zip || ddZip)
-        connect(emulatorProc, SIGNAL(finished(int)), this, SLOT(cleanTemp()));
+    stages << tr("arguments %1 ms").arg(launchTimer.elapsed() - stageStart);
 
+    //Sessions are named after the ROM, or the disk when there is no cartridge
+    QString sessionRom = completeRomPath != "" ? completeRomPath : complete64DDPath;
+    QString sessionName = completeRomPath != "" || ddFileName == "" ? romFileName : ddFileName;
 
-    if (SETTINGS.value("Other/consoleoutput", "").toString() == "true")
-        emulatorProc->setProcessChannelMode(QProcess::ForwardedChannels);
-    else {
-        connect(emulatorProc, SIGNAL(readyReadStandardOutput()), this, SLOT(readOutput()));
-        emulatorProc->setProcessChannelMode(QProcess::MergedChannels);
-    }
-
-    //clear log
-    lastOutput = "";
-
-    emulatorProc->start(emulatorPath, args);
+    EmulatorSession *session = new EmulatorSession(sessionID, QFileInfo(sessionName).completeBaseName(),
+                                                   tempFiles, this);
+    connect(session, SIGNAL(finished(int)), this, SLOT(sessionFinished(int)));
+    connect(session, SIGNAL(statusUpdate(QString)), this, SLOT(sessionStatus(QString)));
 
-    //Add command to log
-    QString executable = emulatorPath;
-    if (executable.contains(" "))
-        executable = '"' + executable + '"';
+    sessions << session;
 
-    QString argString;
+    //Performance samples are kept per ROM, 64DD disks count as the ROM when there is no cartridge
+    QString sessionMD5 = romMD5 != "" ? romMD5.toLower() : getRomMD5(sessionRom);
 
-    foreach(QString arg, args)
-    {
-        if (arg.contains(" "))
-            argString += " \"" + arg + "\"";
-        else
-            argString += " " + arg;
-    }
-
-    lastOutput.append(executable + argString + "\n\n");
+    session->setLaunchTiming(launchTimer, stages);
+    session->start(emulatorPath, args, sessionMD5);
 
+    //Some start failures are reported from inside start(), the session has already finished then
+    if (!sessions.contains(session))
+        return;
 
     updateStatus(tr("Emulation started"), 3000);
-    emit started();
+    emit started(session);
 }
 
 
 void EmulatorHandler::stopEmulator()
 {
-    emulatorProc->terminate();
+    foreach (EmulatorSession *session, sessions)
+        session->stop();
 }
 
 
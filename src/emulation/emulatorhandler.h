@@ -35,7 +35,9 @@
 #include <QDir>
 #include <QObject>
 
-class QProcess;
+class EmulatorLog;
+class EmulatorSession;
+class RomPrefetcher;
 
 
 class EmulatorHandler : public QObject
@@ -43,31 +45,44 @@ class EmulatorHandler : public QObject
     Q_OBJECT
 public:
     explicit EmulatorHandler(QWidget *parent = 0);
+    void cancelPrefetch();
+    static QStringList getEmulatorArgs(QString romPath, QString ddPath = "", bool headless = false,
+                                       QString romMD5 = "", QString saveType = "");
+    EmulatorLog *getLog();
+    QList<EmulatorSession*> getSessions();
+    bool isFull();
+    bool isRunning();
+    void prefetchRom(QDir romDir, QString romFileName, QString zipFileName = "");
     void startEmulator(QDir romDir, QString romFileName, QString zipFileName = "",
-                       QDir ddDir = QDir(), QString ddFileName = "", QString ddZipName = "");
+                       QDir ddDir = QDir(), QString ddFileName = "", QString ddZipName = "",
+                       QString romMD5 = "", QString saveType = "");
     void stopEmulator();
 
-    QString lastOutput;
-
 signals:
     void finished();
-    void showLog();
-    void started();
+    void historySaved(QString romMD5, qint64 time);
+    void started(EmulatorSession *session);
     void statusUpdate(QString message, int timeout);
 
 private:
+    void checkStatus(int status, EmulatorLog *log);
+    void cleanTemp(QStringList tempFiles);
+    void saveHistory(EmulatorSession *session);
     void updateStatus(QString message, int timeout = 0);
 
-    QStringList parseArgString(QString argString);
+    static QString getRomMD5(QString romPath);
+    static QString getTempDir();
+    static QStringList parseArgString(QString argString);
 
-    QProcess *emulatorProc;
+    int nextSession;
+    QList<EmulatorSession*> sessions;
+    EmulatorLog *lastLog;
+    RomPrefetcher *prefetcher;
     QWidget *parent;
 
 private slots:
-    void checkStatus(int status);
-    void cleanTemp();
-    void emitFinished();
-    void readOutput();
+    void sessionFinished(int status);
+    void sessionStatus(QString message);
 };
 
 #endif // EMULATORHANDLER_H
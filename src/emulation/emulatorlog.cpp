@@ -0,0 +1,187 @@
+/***
+ * Copyright (c) 2013, Dan Hasting
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "emulatorlog.h"
+
+#include "../global.h"
+#include "../common.h"
+
+#include <QDir>
+#include <QFile>
+#include <QRegExp>
+#include <QStringList>
+
+
+EmulatorLog::EmulatorLog(QString spillName, int sessionID, QObject *parent) : QObject(parent)
+{
+    count = 0;
+    dropped = 0;
+    first = 0;
+    spillBytes = 0;
+    spillLimit = 0;
+    spill = nullptr;
+
+    //Verbose builds print thousands of lines a minute, only the most recent ones are kept in memory
+    maxLines = qMax(100, SETTINGS.value("Other/loglines", 10000).toInt());
+    lines.resize(maxLines);
+
+    //Optionally everything also goes to a file, rotated by size and at the start of each session
+    if (spillName != "" && SETTINGS.value("Other/logspill", "").toString() == "true") {
+        QString logDir = getDataLocation() + "/logs";
+        QDir().mkpath(logDir);
+
+        //The session ID keeps two running copies of the same ROM out of each other's file
+        spillName.replace(QRegExp("[^A-Za-z0-9._-]"), "_");
+        spillPath = logDir + "/" + spillName + "-" + QString::number(sessionID) + ".log";
+        spillLimit = qMax(1, SETTINGS.value("Other/logsize", 10).toInt()) * 1024 * 1024;
+
+        rotateSpill();
+    }
+}
+
+
+EmulatorLog::~EmulatorLog()
+{
+    delete spill;
+}
+
+
+void EmulatorLog::addLine(QString line)
+{
+    if (count < maxLines)
+        lines[(first + count++) % maxLines] = line;
+    else {
+        lines[first] = line;
+        first = (first + 1) % maxLines;
+        dropped++;
+    }
+
+    if (spill) {
+        //QFile::size() flushes the buffer, so the written bytes are counted instead
+        qint64 written = spill->write(line.toUtf8() + "\n");
+        if (written > 0)
+            spillBytes += written;
+
+        if (spillBytes >= spillLimit)
+            rotateSpill();
+    }
+}
+
+
+void EmulatorLog::append(QString output)
+{
+    QStringList newLines = (partialLine + output).split("\n");
+
+    //The last piece has no newline yet, it's finished by the next chunk
+    partialLine = newLines.takeLast();
+
+    if (newLines.isEmpty())
+        return;
+
+    foreach (QString line, newLines)
+        addLine(line);
+
+    emit appended(newLines.join("\n"));
+}
+
+
+void EmulatorLog::finish()
+{
+    if (partialLine != "") {
+        QString line = partialLine;
+        partialLine = "";
+
+        addLine(line);
+        emit appended(line);
+    }
+
+    if (spill) {
+        spill->close();
+        delete spill;
+        spill = nullptr;
+    }
+}
+
+
+int EmulatorLog::getMaxLines()
+{
+    return maxLines;
+}
+
+
+QString EmulatorLog::getText()
+{
+    QStringList text;
+
+    if (dropped > 0) {
+        if (spillPath != "")
+            text << tr("[%1 earlier lines not shown, see %2]").arg(dropped).arg(spillPath);
+        else
+            text << tr("[%1 earlier lines not shown]").arg(dropped);
+    }
+
+    //An unfinished line is left out, it arrives through appended() once it's complete
+    for (int i = 0; i < count; i++)
+        text << lines.at((first + i) % maxLines);
+
+    return text.join("\n");
+}
+
+
+bool EmulatorLog::isEmpty()
+{
+    return count == 0 && partialLine == "";
+}
+
+
+void EmulatorLog::rotateSpill()
+{
+    int files = qMax(1, SETTINGS.value("Other/logfiles", 3).toInt());
+
+    if (spill) {
+        spill->close();
+        delete spill;
+    }
+
+    //name.log becomes name.log.1 and so on, the oldest is removed
+    QFile::remove(spillPath + "." + QString::number(files));
+    for (int i = files - 1; i >= 1; i--)
+        QFile::rename(spillPath + "." + QString::number(i), spillPath + "." + QString::number(i + 1));
+    QFile::rename(spillPath, spillPath + ".1");
+
+    spill = new QFile(spillPath);
+    spillBytes = 0;
+
+    if (!spill->open(QIODevice::WriteOnly | QIODevice::Text)) {
+        delete spill;
+        spill = nullptr;
+    }
+}
@@ -0,0 +1,72 @@
+/***
+ * Copyright (c) 2013, Dan Hasting
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#ifndef EMULATORLOG_H
+#define EMULATORLOG_H
+
+#include <QObject>
+#include <QVector>
+
+class QFile;
+
+
+class EmulatorLog : public QObject
+{
+    Q_OBJECT
+public:
+    explicit EmulatorLog(QString spillName = "", int sessionID = 0, QObject *parent = 0);
+    ~EmulatorLog();
+    void append(QString output);
+    void finish();
+    int getMaxLines();
+    QString getText();
+    bool isEmpty();
+
+signals:
+    void appended(QString lines);
+
+private:
+    void addLine(QString line);
+    void rotateSpill();
+
+    int count;
+    int dropped;
+    int first;
+    int maxLines;
+    qint64 spillBytes;
+    qint64 spillLimit;
+    QFile *spill;
+    QString partialLine;
+    QString spillPath;
+    QVector<QString> lines;
+};
+
+#endif // EMULATORLOG_H
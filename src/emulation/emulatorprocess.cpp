@@ -0,0 +1,236 @@
+/***
+ * Copyright (c) 2013, Dan Hasting
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "emulatorprocess.h"
+
+#include "../global.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <linux/mempolicy.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+//Not in glibc, see ioprio_set(2)
+#define IOPRIO_WHO_PROCESS 1
+#define IOPRIO_CLASS_SHIFT 13
+#endif
+
+#ifdef CPU_SETSIZE
+static const int maxCPUs = CPU_SETSIZE;
+#else
+static const int maxCPUs = 1024;
+#endif
+
+
+EmulatorProcess::EmulatorProcess(QObject *parent) : QProcess(parent)
+{
+    ioClass = 0;
+    ioLevel = 4;
+    niceness = 0;
+    numaNode = -1;
+
+#ifdef Q_OS_LINUX
+    //Everything is resolved here, the child only gets to make system calls between fork and exec
+    CPU_ZERO(&cpus);
+
+    QList<int> cpuList = getCPUList(SETTINGS.value("Emulation/affinity", "").toString());
+    numaNode = SETTINGS.value("Emulation/numanode", -1).toInt();
+
+    if (numaNode >= 0) {
+        QList<int> nodeCPUs = getNodeCPUs(numaNode);
+        QString node = "NUMA node " + QString::number(numaNode);
+
+        if (nodeCPUs.isEmpty()) {
+            //No such node, keep the affinity as it is and don't ask for its memory
+            placement << node + " has no CPUs, skipped";
+            numaNode = -1;
+        } else {
+            //Both set means the listed cores within that node
+            QList<int> nodeList;
+            foreach (int cpu, cpuList)
+                if (nodeCPUs.contains(cpu))
+                    nodeList << cpu;
+
+            //No overlap would leave the process unpinned, the whole node is closer to what was asked
+            if (nodeList.isEmpty() && !cpuList.isEmpty())
+                placement << node + " (no affinity CPUs in node, using all of them)";
+            else
+                placement << node;
+
+            cpuList = nodeList.isEmpty() ? nodeCPUs : nodeList;
+        }
+    }
+
+    QStringList cpuNames;
+    foreach (int cpu, cpuList)
+    {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &cpus);
+            cpuNames << QString::number(cpu);
+        }
+    }
+
+    if (!cpuNames.isEmpty())
+        placement << "CPUs " + cpuNames.join(",");
+
+    niceness = qBound(-20, SETTINGS.value("Emulation/nice", 0).toInt(), 19);
+    if (niceness != 0)
+        placement << "nice " + QString::number(niceness);
+
+    QString ioSetting = SETTINGS.value("Emulation/ioclass", "").toString();
+    ioLevel = qBound(0, SETTINGS.value("Emulation/iolevel", 4).toInt(), 7);
+
+    if (ioSetting == "realtime")
+        ioClass = 1;
+    else if (ioSetting == "besteffort")
+        ioClass = 2;
+    else if (ioSetting == "idle")
+        ioClass = 3;
+
+    if (ioClass > 0)
+        placement << "I/O " + ioSetting + (ioClass < 3 ? " " + QString::number(ioLevel) : QString());
+
+    QString cgroup = SETTINGS.value("Emulation/cgroup", "").toString();
+
+    if (cgroup != "") {
+        QFileInfo procsFile(QDir(cgroup).absoluteFilePath("cgroup.procs"));
+
+        if (procsFile.isWritable()) {
+            cgroupProcs = QFile::encodeName(procsFile.absoluteFilePath());
+            placement << "cgroup " + cgroup;
+        } else
+            placement << "cgroup " + cgroup + " not writable, skipped";
+    }
+#endif
+}
+
+
+QList<int> EmulatorProcess::getCPUList(QString cpuList)
+{
+    QList<int> result;
+
+    //Same format as /sys and taskset -c, like "0-3,8,10-11"
+    foreach (QString range, cpuList.split(","))
+    {
+        QStringList bounds = range.trimmed().split("-");
+        bool firstOk = false, lastOk = false;
+
+        int first = bounds.first().toInt(&firstOk);
+        int last = bounds.last().toInt(&lastOk);
+
+        if (!firstOk || !lastOk || bounds.size() > 2)
+            continue;
+
+        //A typo like "0-2000000000" would otherwise take forever to expand
+        first = qMax(first, 0);
+        last = qMin(last, maxCPUs - 1);
+
+        for (int cpu = first; cpu <= last; cpu++)
+            if (!result.contains(cpu))
+                result << cpu;
+    }
+
+    return result;
+}
+
+
+QList<int> EmulatorProcess::getNodeCPUs(int node)
+{
+    QFile cpuListFile("/sys/devices/system/node/node" + QString::number(node) + "/cpulist");
+
+    if (!cpuListFile.open(QIODevice::ReadOnly | QIODevice::Text))
+        return QList<int>();
+
+    QString cpuList = cpuListFile.readAll();
+    cpuListFile.close();
+
+    return getCPUList(cpuList);
+}
+
+
+QString EmulatorProcess::getPlacement()
+{
+    return placement.join(", ");
+}
+
+
+void EmulatorProcess::setupChildProcess()
+{
+#ifdef Q_OS_LINUX
+    //Runs in the child after fork, so nothing here may allocate or lock
+
+    //Join the cgroup first so its cpuset applies before the affinity is narrowed further
+    if (!cgroupProcs.isEmpty()) {
+        char pid[16];
+        int length = 0;
+
+        for (pid_t value = getpid(); value > 0 && length < 15; value /= 10)
+            pid[length++] = '0' + value % 10;
+
+        for (int i = 0; i < length / 2; i++)
+        {
+            char digit = pid[i];
+            pid[i] = pid[length - 1 - i];
+            pid[length - 1 - i] = digit;
+        }
+
+        int fd = open(cgroupProcs.constData(), O_WRONLY);
+        if (fd >= 0) {
+            ssize_t written = write(fd, pid, length);
+            Q_UNUSED(written);
+            close(fd);
+        }
+    }
+
+    //Threads started by -multithread inherit all of these from the main thread
+    if (CPU_COUNT(&cpus) > 0)
+        sched_setaffinity(0, sizeof(cpus), &cpus);
+
+    //Prefer the node's memory without failing allocations when it runs out
+    if (numaNode >= 0 && numaNode < int(sizeof(unsigned long) * 8)) {
+        unsigned long nodeMask = 1UL << numaNode;
+        //maxnode is one more than the bits in the mask, the kernel drops the last one (see numactl)
+        syscall(SYS_set_mempolicy, MPOL_PREFERRED, &nodeMask, sizeof(nodeMask) * 8 + 1);
+    }
+
+    if (niceness != 0)
+        setpriority(PRIO_PROCESS, 0, niceness);
+
+    if (ioClass > 0)
+        syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, (ioClass << IOPRIO_CLASS_SHIFT) | ioLevel);
+#endif
+}
@@ -0,0 +1,297 @@
+/***
+ * Copyright (c) 2013, Dan Hasting
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "emulatorsession.h"
+#include "emulatorlog.h"
+#include "emulatorprocess.h"
+#include "telemetry.h"
+
+#include "../global.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+
+
+EmulatorSession::EmulatorSession(int id, QString name, QStringList tempFiles, QObject *parent) : QObject(parent)
+{
+    this->id = id;
+    this->name = name;
+    this->tempFiles = tempFiles;
+
+    status = "";
+    crashed = false;
+    exitCode = 0;
+    started = 0;
+    ended = 0;
+
+    log = new EmulatorLog(name, id, this);
+    process = new EmulatorProcess(this);
+    telemetry = new Telemetry(this);
+
+    connect(process, SIGNAL(finished(int)), this, SLOT(processFinished(int)));
+    connect(process, SIGNAL(started()), this, SLOT(processStarted()));
+#if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+    connect(process, SIGNAL(errorOccurred(QProcess::ProcessError)), this, SLOT(processError(QProcess::ProcessError)));
+#else
+    connect(process, SIGNAL(error(QProcess::ProcessError)), this, SLOT(processError(QProcess::ProcessError)));
+#endif
+}
+
+
+void EmulatorSession::cleanTemp()
+{
+    foreach (QString tempFile, tempFiles)
+    {
+        QFile::remove(tempFile);
+        QDir().rmdir(QFileInfo(tempFile).path());
+    }
+}
+
+
+void EmulatorSession::finishTelemetry()
+{
+    summary = telemetry->finish();
+    int samples = summary.value("samples").toInt();
+
+    if (samples == 0)
+        return;
+
+    QString line = "%1: min %2, mean %3, p1 %4, p99 %5\n";
+    QStringList names, keys;
+    names << "VI/s" << "MHz";
+    keys << "vi" << "mhz";
+
+    log->append("\n" + tr("Performance over %1 samples:").arg(samples) + "\n");
+
+    for (int i = 0; i < keys.size(); i++)
+    {
+        QJsonObject statistics = summary.value(keys.at(i)).toObject();
+        log->append(line.arg(names.at(i))
+                       .arg(statistics.value("min").toDouble(), 0, 'f', 2)
+                       .arg(statistics.value("mean").toDouble(), 0, 'f', 2)
+                       .arg(statistics.value("p1").toDouble(), 0, 'f', 2)
+                       .arg(statistics.value("p99").toDouble(), 0, 'f', 2));
+    }
+}
+
+
+int EmulatorSession::getID()
+{
+    return id;
+}
+
+
+EmulatorLog *EmulatorSession::getLog()
+{
+    return log;
+}
+
+
+QString EmulatorSession::getName()
+{
+    return name;
+}
+
+
+QVariantMap EmulatorSession::getRecord()
+{
+    QVariantMap record;
+    record.insert("md5", romMD5.toUpper());
+    record.insert("emulator", emulatorPath);
+    record.insert("args_hash", argsHash);
+    record.insert("started", started);
+    record.insert("ended", ended);
+    record.insert("exit_code", exitCode);
+    record.insert("crashed", crashed ? 1 : 0);
+    record.insert("samples", summary.value("samples").toInt());
+
+    //Kept as columns too so slow ROMs can be found without parsing the summary
+    if (summary.contains("vi")) {
+        record.insert("vi_mean", summary.value("vi").toObject().value("mean").toDouble());
+        record.insert("vi_p1", summary.value("vi").toObject().value("p1").toDouble());
+        record.insert("mhz_mean", summary.value("mhz").toObject().value("mean").toDouble());
+    }
+
+    record.insert("summary", QString(QJsonDocument(summary).toJson(QJsonDocument::Compact)));
+
+    return record;
+}
+
+
+QString EmulatorSession::getRomMD5()
+{
+    return romMD5;
+}
+
+
+qint64 EmulatorSession::getRunningTime()
+{
+    return clock.isValid() ? clock.elapsed() : 0;
+}
+
+
+QString EmulatorSession::getStatus()
+{
+    return status;
+}
+
+
+Telemetry *EmulatorSession::getTelemetry()
+{
+    return telemetry;
+}
+
+
+bool EmulatorSession::isRunning()
+{
+    return process->state() != QProcess::NotRunning;
+}
+
+
+void EmulatorSession::processError(QProcess::ProcessError error)
+{
+    //finished() never comes when the process couldn't be started, so end the session here
+    if (error != QProcess::FailedToStart)
+        return;
+
+    log->append(tr("Could not start %1: %2").arg(emulatorPath, process->errorString()) + "\n");
+    processFinished(-1);
+}
+
+
+void EmulatorSession::processFinished(int status)
+{
+    ended = QDateTime::currentMSecsSinceEpoch();
+    exitCode = status;
+    crashed = process->exitStatus() == QProcess::CrashExit;
+
+    finishTelemetry();
+    log->finish();
+    cleanTemp();
+
+    emit finished(status);
+}
+
+
+void EmulatorSession::processStarted()
+{
+    if (launchTimer.isValid())
+        log->append(tr("Launch: %1, process started after %2 ms")
+                    .arg(launchStages.join(", ")).arg(launchTimer.elapsed()) + "\n");
+
+    log->append("\n");
+}
+
+
+void EmulatorSession::readOutput()
+{
+    QString output = process->readAllStandardOutput();
+    QStringList outputList = output.split("\n");
+
+    telemetry->addOutput(output);
+
+    int lastIndex = outputList.lastIndexOf(QRegExp("^.*VI/s.*MHz$"));
+
+    if (lastIndex >= 0) {
+        status = outputList[lastIndex];
+        emit statusUpdate(status);
+    }
+
+    log->append(output);
+}
+
+
+void EmulatorSession::setLaunchTiming(QElapsedTimer launchTimer, QStringList stages)
+{
+    this->launchTimer = launchTimer;
+    launchStages = stages;
+}
+
+
+void EmulatorSession::start(QString emulatorPath, QStringList args, QString romMD5)
+{
+    if (SETTINGS.value("Other/consoleoutput", "").toString() == "true")
+        process->setProcessChannelMode(QProcess::ForwardedChannels);
+    else {
+        connect(process, SIGNAL(readyReadStandardOutput()), this, SLOT(readOutput()));
+        process->setProcessChannelMode(QProcess::MergedChannels);
+    }
+
+    this->emulatorPath = emulatorPath;
+    this->romMD5 = romMD5;
+
+    //Temp ROM paths change every launch, so they're left out of the hash that identifies the setup
+    QStringList hashArgs = args;
+    foreach (QString tempFile, tempFiles)
+        hashArgs.replaceInStrings(tempFile, "<temp>");
+
+    argsHash = QCryptographicHash::hash(hashArgs.join(QChar('\0')).toUtf8(), QCryptographicHash::Md5).toHex();
+    started = QDateTime::currentMSecsSinceEpoch();
+
+    //Add command to log. Logged first, a failed start finishes the log from inside process->start()
+    QString executable = emulatorPath;
+    if (executable.contains(" "))
+        executable = '"' + executable + '"';
+
+    QString argString;
+
+    foreach(QString arg, args)
+    {
+        if (arg.contains(" "))
+            argString += " \"" + arg + "\"";
+        else
+            argString += " " + arg;
+    }
+
+    log->append(executable + argString + "\n");
+
+    if (process->getPlacement() != "")
+        log->append(tr("Placement: %1").arg(process->getPlacement()) + "\n");
+
+    process->start(emulatorPath, args);
+
+    //Couldn't be started, processError() has already ended the session
+    if (process->state() == QProcess::NotRunning && ended != 0)
+        return;
+
+    telemetry->start(romMD5, emulatorPath);
+    clock.start();
+}
+
+
+void EmulatorSession::stop()
+{
+    process->terminate();
+}
@@ -0,0 +1,99 @@
+/***
+ * Copyright (c) 2013, Dan Hasting
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#ifndef EMULATORSESSION_H
+#define EMULATORSESSION_H
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QObject>
+#include <QProcess>
+#include <QStringList>
+#include <QVariantMap>
+
+class EmulatorLog;
+class EmulatorProcess;
+class Telemetry;
+
+
+class EmulatorSession : public QObject
+{
+    Q_OBJECT
+public:
+    explicit EmulatorSession(int id, QString name, QStringList tempFiles, QObject *parent = 0);
+    int getID();
+    EmulatorLog *getLog();
+    QString getName();
+    QVariantMap getRecord();
+    QString getRomMD5();
+    qint64 getRunningTime();
+    QString getStatus();
+    Telemetry *getTelemetry();
+    bool isRunning();
+    void setLaunchTiming(QElapsedTimer launchTimer, QStringList stages);
+    void start(QString emulatorPath, QStringList args, QString romMD5);
+    void stop();
+
+signals:
+    void finished(int status);
+    void statusUpdate(QString message);
+
+private:
+    void cleanTemp();
+    void finishTelemetry();
+
+    bool crashed;
+    int exitCode;
+    int id;
+    qint64 ended;
+    qint64 started;
+    QElapsedTimer clock;
+    QElapsedTimer launchTimer;
+    QJsonObject summary;
+    QString argsHash;
+    QString emulatorPath;
+    QString name;
+    QString romMD5;
+    QString status;
+    QStringList launchStages;
+    QStringList tempFiles;
+    EmulatorLog *log;
+    EmulatorProcess *process;
+    Telemetry *telemetry;
+
+private slots:
+    void processError(QProcess::ProcessError error);
+    void processFinished(int status);
+    void processStarted();
+    void readOutput();
+};
+
+#endif // EMULATORSESSION_H
@@ -0,0 +1,216 @@
+/***
+ * Copyright (c) 2013, Dan Hasting
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "romprefetcher.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <quazip5/quazipfile.h>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+//Small enough that a cancel is noticed quickly even on a slow network drive
+static const qint64 chunkSize = 256 * 1024;
+
+
+RomPrefetcher::RomPrefetcher(QString tempDir, QObject *parent) : QObject(parent)
+{
+    this->tempDir = tempDir + "/prefetch";
+
+    key = "";
+
+    //Wait for the highlight to settle so scrolling through the collection doesn't queue reads
+    delayTimer = new QTimer(this);
+    delayTimer->setSingleShot(true);
+    delayTimer->setInterval(300);
+
+    connect(delayTimer, SIGNAL(timeout()), this, SLOT(startPrefetch()));
+}
+
+
+RomPrefetcher::~RomPrefetcher()
+{
+    cancel();
+
+    //Canceled jobs stop at their next chunk, but they still point at currentJob until then
+    foreach (QFuture<QString> job, jobs)
+        job.waitForFinished();
+
+    QDir(tempDir).removeRecursively();
+}
+
+
+void RomPrefetcher::cancel()
+{
+    delayTimer->stop();
+
+    //Running jobs compare against this between chunks and stop on their own
+    currentJob.ref();
+
+    if (future.isFinished() && future.resultCount() > 0)
+        removeExtracted(future.result());
+
+    future = QFuture<QString>();
+    key = "";
+}
+
+
+QString RomPrefetcher::extract(QString romFileName, QString zipFile, QString targetDir,
+                               int job, QAtomicInt *currentJob)
+{
+    QuaZipFile zippedFile(zipFile, romFileName);
+
+    if (!zippedFile.open(QIODevice::ReadOnly))
+        return "";
+
+    //Same name the launch would extract to, zipped ROMs' save files are named after it
+    QDir().mkpath(targetDir);
+    QString romPath = targetDir + "/temp.bin";
+    QFile tempRom(romPath);
+
+    bool failed = !tempRom.open(QIODevice::WriteOnly);
+
+    while (!failed && currentJob->load() == job && !zippedFile.atEnd())
+    {
+        QByteArray data = zippedFile.read(chunkSize);
+
+        if (data.isEmpty() || tempRom.write(data) != data.size())
+            failed = true;
+    }
+
+    tempRom.close();
+    zippedFile.close();
+
+    if (failed || currentJob->load() != job) {
+        removeExtracted(romPath);
+        return "";
+    }
+
+    return romPath;
+}
+
+
+void RomPrefetcher::prefetch(QString romFileName, QString zipFile)
+{
+    //Already prefetched or on its way
+    if (key == zipFile + "/" + romFileName)
+        return;
+
+    cancel();
+
+    key = zipFile + "/" + romFileName;
+    pendingRom = romFileName;
+    pendingZip = zipFile;
+
+    delayTimer->start();
+}
+
+
+void RomPrefetcher::removeExtracted(QString romPath)
+{
+    if (romPath == "")
+        return;
+
+    QFile::remove(romPath);
+    QDir().rmdir(QFileInfo(romPath).path());
+}
+
+
+void RomPrefetcher::startPrefetch()
+{
+    int job = currentJob.load();
+
+    foreach (QFuture<QString> finished, jobs)
+    {
+        if (finished.isFinished())
+            jobs.removeOne(finished);
+    }
+
+    if (pendingZip != "")
+        future = QtConcurrent::run(extract, pendingRom, pendingZip,
+                                   tempDir + "/" + QString::number(job), job, &currentJob);
+    else
+        future = QtConcurrent::run(warm, pendingRom, job, &currentJob);
+
+    jobs << future;
+}
+
+
+QString RomPrefetcher::takeExtracted(QString romFileName, QString zipFile)
+{
+    if (key != zipFile + "/" + romFileName || delayTimer->isActive()) {
+        cancel();
+        return "";
+    }
+
+    //The launch would have to extract this same file, so whatever is done already is a head start
+    future.waitForFinished();
+
+    QString romPath = future.resultCount() > 0 ? future.result() : "";
+
+    future = QFuture<QString>();
+    key = "";
+
+    return romPath;
+}
+
+
+QString RomPrefetcher::warm(QString romPath, int job, QAtomicInt *currentJob)
+{
+#ifdef Q_OS_LINUX
+    //The kernel reads ahead in the background, so there's nothing here to cancel
+    Q_UNUSED(job);
+    Q_UNUSED(currentJob);
+
+    int fd = open(QFile::encodeName(romPath).constData(), O_RDONLY);
+
+    if (fd >= 0) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+        close(fd);
+    }
+#else
+    QFile romFile(romPath);
+
+    if (romFile.open(QIODevice::ReadOnly)) {
+        while (currentJob->load() == job && !romFile.read(chunkSize).isEmpty());
+        romFile.close();
+    }
+#endif
+
+    return "";
+}
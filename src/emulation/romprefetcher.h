@@ -0,0 +1,71 @@
+/***
+ * Copyright (c) 2013, Dan Hasting
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#ifndef ROMPREFETCHER_H
+#define ROMPREFETCHER_H
+
+#include <QAtomicInt>
+#include <QFuture>
+#include <QObject>
+
+class QTimer;
+
+
+class RomPrefetcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit RomPrefetcher(QString tempDir, QObject *parent = 0);
+    ~RomPrefetcher();
+    void cancel();
+    void prefetch(QString romFileName, QString zipFile = "");
+    QString takeExtracted(QString romFileName, QString zipFile);
+
+private:
+    static QString extract(QString romFileName, QString zipFile, QString targetDir,
+                           int job, QAtomicInt *currentJob);
+    static void removeExtracted(QString romPath);
+    static QString warm(QString romPath, int job, QAtomicInt *currentJob);
+
+    QAtomicInt currentJob;
+    QFuture<QString> future;
+    QList<QFuture<QString> > jobs;
+    QString key;
+    QString pendingRom;
+    QString pendingZip;
+    QString tempDir;
+    QTimer *delayTimer;
+
+private slots:
+    void startPrefetch();
+};
+
+#endif // ROMPREFETCHER_H
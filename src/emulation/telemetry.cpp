@@ -0,0 +1,207 @@
+/***
+ * Copyright (c) 2013, Dan Hasting
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "telemetry.h"
+
+#include "../global.h"
+#include "../common.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRegExp>
+#include <QSaveFile>
+
+#include <algorithm>
+
+
+static double parseValue(QString line, QString unit, bool *found)
+{
+    //Accept both "VI/s: 60.00" and "60.00 VI/s"
+    QRegExp after(QRegExp::escape(unit) + ":?\\s*(\\d+(?:\\.\\d+)?)");
+    QRegExp before("(\\d+(?:\\.\\d+)?)\\s*" + QRegExp::escape(unit));
+
+    *found = true;
+
+    if (after.indexIn(line) != -1)
+        return after.cap(1).toDouble();
+    if (before.indexIn(line) != -1)
+        return before.cap(1).toDouble();
+
+    *found = false;
+    return 0;
+}
+
+
+Telemetry::Telemetry(QObject *parent) : QObject(parent)
+{
+    qRegisterMetaType<TelemetrySample>("TelemetrySample");
+
+    saveHistory = true;
+}
+
+
+void Telemetry::addOutput(QString output)
+{
+    //Output arrives in chunks, so hold on to a line until it is complete
+    QStringList lines = (partialLine + output).split("\n");
+    partialLine = lines.takeLast();
+
+    foreach (QString line, lines)
+    {
+        bool viFound, mhzFound;
+
+        TelemetrySample sample;
+        sample.time = clock.elapsed();
+        sample.viPerSecond = parseValue(line, "VI/s", &viFound);
+        sample.mhz = parseValue(line, "MHz", &mhzFound);
+
+        if (viFound && mhzFound) {
+            samples << sample;
+            emit sampleAdded(sample);
+        }
+    }
+}
+
+
+QJsonObject Telemetry::finish()
+{
+    QJsonObject summary = getSummary();
+
+    if (saveHistory && romMD5 != "" && !samples.isEmpty())
+        saveSummary(summary);
+
+    return summary;
+}
+
+
+TelemetrySample Telemetry::getLastSample()
+{
+    if (samples.isEmpty()) {
+        TelemetrySample empty = { 0, 0, 0 };
+        return empty;
+    }
+
+    return samples.last();
+}
+
+
+QVector<TelemetrySample> Telemetry::getSamples()
+{
+    return samples;
+}
+
+
+QJsonObject Telemetry::getStatistics(QVector<double> values)
+{
+    QJsonObject statistics;
+
+    if (values.isEmpty())
+        return statistics;
+
+    std::sort(values.begin(), values.end());
+
+    double total = 0;
+    foreach (double value, values)
+        total += value;
+
+    //Nearest-rank percentiles, p1 shows the worst stutters without a single outlier deciding it
+    statistics.insert("min", values.first());
+    statistics.insert("mean", total / values.size());
+    statistics.insert("p1", values.at(int(0.01 * (values.size() - 1))));
+    statistics.insert("p99", values.at(int(0.99 * (values.size() - 1))));
+
+    return statistics;
+}
+
+
+QJsonObject Telemetry::getSummary()
+{
+    QVector<double> viValues, mhzValues;
+
+    foreach (TelemetrySample sample, samples)
+    {
+        viValues << sample.viPerSecond;
+        mhzValues << sample.mhz;
+    }
+
+    QJsonObject summary;
+    summary.insert("date", QDateTime::currentDateTime().toString(Qt::ISODate));
+    summary.insert("emulator", emulatorPath);
+    summary.insert("duration", clock.elapsed() / 1000.0);
+    summary.insert("samples", samples.size());
+    summary.insert("vi", getStatistics(viValues));
+    summary.insert("mhz", getStatistics(mhzValues));
+
+    return summary;
+}
+
+
+void Telemetry::saveSummary(QJsonObject summary)
+{
+    QString telemetryDir = getDataLocation() + "/telemetry";
+    QDir().mkpath(telemetryDir);
+
+    QString fileName = telemetryDir + "/" + romMD5.toLower() + ".json";
+    QFile file(fileName);
+
+    QJsonArray sessions;
+
+    if (file.open(QIODevice::ReadOnly)) {
+        sessions = QJsonDocument::fromJson(file.readAll()).array();
+        file.close();
+    }
+
+    //Keep enough history to compare builds without the file growing forever
+    sessions.append(summary);
+    while (sessions.size() > SETTINGS.value("Other/telemetryhistory", 100).toInt())
+        sessions.removeFirst();
+
+    QSaveFile saveFile(fileName);
+
+    if (saveFile.open(QIODevice::WriteOnly)) {
+        saveFile.write(QJsonDocument(sessions).toJson());
+        saveFile.commit();
+    }
+}
+
+
+void Telemetry::start(QString romMD5, QString emulatorPath, bool saveHistory)
+{
+    this->romMD5 = romMD5;
+    this->emulatorPath = emulatorPath;
+    this->saveHistory = saveHistory;
+
+    partialLine = "";
+    samples.clear();
+    clock.start();
+}
@@ -0,0 +1,77 @@
+/***
+ * Copyright (c) 2013, Dan Hasting
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QObject>
+#include <QVector>
+
+
+struct TelemetrySample {
+    qint64 time;
+    double viPerSecond;
+    double mhz;
+};
+
+
+class Telemetry : public QObject
+{
+    Q_OBJECT
+public:
+    explicit Telemetry(QObject *parent = 0);
+    void addOutput(QString output);
+    QJsonObject finish();
+    TelemetrySample getLastSample();
+    QVector<TelemetrySample> getSamples();
+    QJsonObject getSummary();
+    void start(QString romMD5, QString emulatorPath, bool saveHistory = true);
+
+signals:
+    void sampleAdded(TelemetrySample sample);
+
+private:
+    QJsonObject getStatistics(QVector<double> values);
+    void saveSummary(QJsonObject summary);
+
+    bool saveHistory;
+    QElapsedTimer clock;
+    QString emulatorPath;
+    QString partialLine;
+    QString romMD5;
+    QVector<TelemetrySample> samples;
+};
+
+Q_DECLARE_METATYPE(TelemetrySample)
+
+#endif // TELEMETRY_H
@@ -33,7 +33,10 @@
 #include "common.h"
 #include "mainwindow.h"
 
+#include "emulation/emulatorbenchmark.h"
+
 #include <QApplication>
+#include <QCommandLineParser>
 #include <QDesktopWidget>
 #include <QFileInfo>
 #include <QScreen>
@@ -58,6 +61,50 @@ int main(int argc, char *argv[])
     QCoreApplication::setOrganizationName(ParentName);
     QCoreApplication::setApplicationName(AppName);
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+
+    QCommandLineOption benchmarkOption("benchmark",
+        QCoreApplication::translate("main", "Run ROMs from the collection with -novideo -noaudio, write their "
+                                            "VI/s and MHz as CSV, or JSON if the output ends in .json, and exit."));
+    QCommandLineOption romsOption("benchmark-roms",
+        QCoreApplication::translate("main", "Wildcard matched against file and internal names for --benchmark. "
+                                            "Defaults to all cartridges."), "pattern");
+    QCommandLineOption durationOption("benchmark-duration",
+        QCoreApplication::translate("main", "Seconds to run each ROM for. Defaults to 30."), "seconds", "30");
+    QCommandLineOption coresOption("benchmark-cores",
+        QCoreApplication::translate("main", "Cores to spread instances over. Defaults to all of them."), "count");
+    QCommandLineOption outputOption("benchmark-output",
+        QCoreApplication::translate("main", "Report file. Defaults to standard output."), "file");
+    QCommandLineOption emulatorOption("benchmark-cen64",
+        QCoreApplication::translate("main", "Executable to run instead of Paths/cen64, any program printing "
+                                            "VI/s lines will do."), "path");
+    QCommandLineOption compareOption("benchmark-compare",
+        QCoreApplication::translate("main", "Second executable to compare against, runs alternate between "
+                                            "the two and the report shows the speed difference per ROM."), "path");
+    QCommandLineOption repeatsOption("benchmark-repeats",
+        QCoreApplication::translate("main", "Runs per ROM and executable. Defaults to 5 when comparing, "
+                                            "otherwise 1."), "count");
+
+    parser.addOption(benchmarkOption);
+    parser.addOption(romsOption);
+    parser.addOption(durationOption);
+    parser.addOption(coresOption);
+    parser.addOption(outputOption);
+    parser.addOption(emulatorOption);
+    parser.addOption(compareOption);
+    parser.addOption(repeatsOption);
+    parser.process(application);
+
+    //Runs without a window so it can be tracked from scripts across changes
+    if (parser.isSet(benchmarkOption)) {
+        EmulatorBenchmark benchmark(parser.value(romsOption), parser.value(durationOption).toInt(),
+                                    parser.value(coresOption).toInt(), parser.value(outputOption),
+                                    parser.value(emulatorOption), parser.value(compareOption),
+                                    parser.value(repeatsOption).toInt());
+        return application.exec();
+    }
+
     MainWindow window;
 
 
@@ -36,11 +36,15 @@
 
 #include "dialogs/aboutdialog.h"
 #include "dialogs/downloaddialog.h"
+#include "dialogs/infobundle.h"
 #include "dialogs/logdialog.h"
 #include "dialogs/settingsdialog.h"
 #include "dialogs/v64converter.h"
 
 #include "emulation/emulatorhandler.h"
+#include "emulation/emulatorlog.h"
+#include "emulation/emulatorsession.h"
+#include "emulation/telemetry.h"
 
 #include "roms/romcollection.h"
 #include "roms/thegamesdbscraper.h"
@@ -49,10 +53,13 @@
 #include "views/listview.h"
 #include "views/tableview.h"
 #include "views/ddview.h"
+#include "views/widgets/performancegraph.h"
+#include "views/widgets/sessionlist.h"
 
 #include <QCloseEvent>
 #include <QDesktopServices>
 #include <QDialogButtonBox>
+#include <QDockWidget>
 #include <QFileDialog>
 #include <QGridLayout>
 #include <QLabel>
@@ -60,6 +67,8 @@
 #include <QMenuBar>
 #include <QMessageBox>
 #include <QOperatingSystemVersion>
+#include <QProgressBar>
+#include <QPushButton>
 #include <QSplitter>
 #include <QStatusBar>
 #include <QTimer>
@@ -76,20 +85,45 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent)
     romCollection = new RomCollection(QStringList() << "*.z64" << "*.n64" << "*.zip" << "*.ndd",
                                       QStringList() << SETTINGS.value("Paths/roms","").toString().split("|"),
                                       this);
+
+    //Live speed of the running game, docked below the ROM views
+    performanceGraph = new PerformanceGraph(this);
+    performanceDock = new QDockWidget(tr("Performance"), this);
+    performanceDock->setObjectName("performanceDock");
+    performanceDock->setWidget(performanceGraph);
+    addDockWidget(Qt::BottomDockWidgetArea, performanceDock);
+
+    if (SETTINGS.value("View/performance", "").toString() == "")
+        performanceDock->hide();
+
+    //Running games with their live speed, the graph follows the one selected here
+    sessionList = new SessionList(emulation, this);
+    sessionDock = new QDockWidget(tr("Sessions"), this);
+    sessionDock->setObjectName("sessionDock");
+    sessionDock->setWidget(sessionList);
+    addDockWidget(Qt::BottomDockWidgetArea, sessionDock);
+
+    if (SETTINGS.value("View/sessions", "").toString() == "")
+        sessionDock->hide();
+
     createMenu();
     createRomView();
 
-    connect(emulation, SIGNAL(started()), this, SLOT(disableButtons()));
+    connect(emulation, SIGNAL(started(EmulatorSession*)), this, SLOT(disableButtons()));
     connect(emulation, SIGNAL(finished()), this, SLOT(enableButtons()));
-    connect(emulation, SIGNAL(showLog()), this, SLOT(openLog()));
     connect(emulation, SIGNAL(statusUpdate(QString, int)), this, SLOT(updateStatusBar(QString, int)));
-
-    connect(romCollection, SIGNAL(updateStarted(bool)), this, SLOT(disableViews(bool)));
-    connect(romCollection, SIGNAL(romAdded(Rom*, int)), this, SLOT(addToView(Rom*, int)));
-    connect(romCollection, SIGNAL(ddRomAdded(Rom*)), ddView, SLOT(addTo64DDView(Rom*)));
+    connect(emulation, SIGNAL(started(EmulatorSession*)), sessionList, SLOT(addSession(EmulatorSession*)));
+    connect(emulation, SIGNAL(finished()), sessionList, SLOT(refresh()));
+    connect(sessionList, SIGNAL(sessionSelected(EmulatorSession*)), this, SLOT(showSession(EmulatorSession*)));
+    connect(emulation, SIGNAL(historySaved(QString, qint64)), romCollection, SLOT(updatePlayHistory(QString, qint64)));
+
+    connect(romCollection, SIGNAL(updateStarted(bool)), this, SLOT(resetViews(bool)));
+    connect(romCollection, SIGNAL(romsAdded(Rom*, int, int)), this, SLOT(addToView(Rom*, int, int)));
+    connect(romCollection, SIGNAL(ddRomsAdded(Rom*, int)), ddView, SLOT(addTo64DDView(Rom*, int)));
+    connect(romCollection, SIGNAL(romUpdated(Rom*)), this, SLOT(updateRomInView(Rom*)));
+    connect(romCollection, SIGNAL(scanProgress(int, int)), this, SLOT(updateScanProgress(int, int)));
     connect(romCollection, SIGNAL(updateEnded(int, bool)), this, SLOT(enableViews(int, bool)));
-
-    romCollection->cachedRoms(false, true);
+    connect(romCollection, SIGNAL(statusUpdate(QString, int)), this, SLOT(updateStatusBar(QString, int)));
 
 
     mainWidget = new QWidget(this);
@@ -101,6 +135,25 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent)
 
     statusBar = new QStatusBar;
 
+    //Progress of ROM scans, shown in the status bar while the views fill in
+    scanProgressBar = new QProgressBar(statusBar);
+    scanProgressBar->setMaximumWidth(200);
+    scanProgressBar->setHidden(true);
+
+    scanPauseButton = new QPushButton(tr("Pause"), statusBar);
+    scanPauseButton->setCheckable(true);
+    scanPauseButton->setHidden(true);
+
+    scanCancelButton = new QPushButton(tr("Cancel"), statusBar);
+    scanCancelButton->setHidden(true);
+
+    statusBar->addPermanentWidget(scanProgressBar);
+    statusBar->addPermanentWidget(scanPauseButton);
+    statusBar->addPermanentWidget(scanCancelButton);
+
+    connect(scanPauseButton, SIGNAL(toggled(bool)), romCollection, SLOT(pauseScan(bool)));
+    connect(scanCancelButton, SIGNAL(clicked()), romCollection, SLOT(cancelScan()));
+
     if (SETTINGS.value("View/statusbar", "").toString() == "")
         statusBar->hide();
     if (SETTINGS.value("View/fullscreen", "").toString() == "true")
@@ -123,19 +176,24 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent)
 
     mainWidget->setLayout(mainLayout);
     mainWidget->setMinimumSize(300, 200);
+
+    romCollection->cachedRoms(false, true);
 }
 
 
-void MainWindow::addToView(Rom *currentRom, int count)
+void MainWindow::addToView(Rom *roms, int first, int count)
 {
+    if (count == 0)
+        return;
+
     QString visibleLayout = SETTINGS.value("View/layout", "none").toString();
 
     if (visibleLayout == "table")
-        tableView->addToTableView(currentRom);
+        tableView->addToTableView(roms, count);
     else if (visibleLayout == "grid")
-        gridView->addToGridView(currentRom, count, ddAction->isChecked());
+        gridView->addToGridView(roms, first, count, ddAction->isChecked());
     else if (visibleLayout == "list")
-        listView->addToListView(currentRom, count, ddAction->isChecked());
+        listView->addToListView(roms, first, count, ddAction->isChecked());
 }
 
 
@@ -157,6 +215,16 @@ void MainWindow::closeEvent(QCloseEvent *event)
         sizes << QString::number(size);
     SETTINGS.setValue("View/64ddsize", sizes.join("|"));
 
+    if (performanceDock->isVisible())
+        SETTINGS.setValue("View/performance", true);
+    else
+        SETTINGS.setValue("View/performance", "");
+
+    if (sessionDock->isVisible())
+        SETTINGS.setValue("View/sessions", true);
+    else
+        SETTINGS.setValue("View/sessions", "");
+
     event->accept();
 }
 
@@ -174,6 +242,9 @@ void MainWindow::createMenu()
     refreshAction = fileMenu->addAction(tr("&Refresh List"));
     downloadAction = fileMenu->addAction(tr("&Download/Update Info..."));
     deleteAction = fileMenu->addAction(tr("D&elete Current Info..."));
+    updateAllAction = fileMenu->addAction(tr("Update &All Info"));
+    exportAction = fileMenu->addAction(tr("E&xport Info..."));
+    importAction = fileMenu->addAction(tr("&Import Info..."));
 #ifndef Q_OS_OSX //OSX does not show the quit action so the separator is unneeded
     fileMenu->addSeparator();
 #endif
@@ -186,6 +257,12 @@ void MainWindow::createMenu()
     downloadAction->setEnabled(false);
     deleteAction->setEnabled(false);
 
+    if (SETTINGS.value("Other/downloadinfo", "").toString() == "") {
+        updateAllAction->setEnabled(false);
+        exportAction->setEnabled(false);
+        importAction->setEnabled(false);
+    }
+
     menuBar->addMenu(fileMenu);
 
     connect(openAction, SIGNAL(triggered()), this, SLOT(openRom()));
@@ -193,6 +270,9 @@ void MainWindow::createMenu()
     connect(refreshAction, SIGNAL(triggered()), romCollection, SLOT(addRoms()));
     connect(downloadAction, SIGNAL(triggered()), this, SLOT(openDownloader()));
     connect(deleteAction, SIGNAL(triggered()), this, SLOT(openDeleteDialog()));
+    connect(updateAllAction, SIGNAL(triggered()), romCollection, SLOT(refreshGameInfo()));
+    connect(exportAction, SIGNAL(triggered()), this, SLOT(openExporter()));
+    connect(importAction, SIGNAL(triggered()), this, SLOT(openImporter()));
     connect(quitAction, SIGNAL(triggered()), this, SLOT(close()));
 
 
@@ -278,6 +358,14 @@ void MainWindow::createMenu()
         fullScreenAction = new QAction(this);
     statusBarAction = viewMenu->addAction(tr("&Status Bar"));
 
+    QAction *performanceAction = performanceDock->toggleViewAction();
+    performanceAction->setText(tr("&Performance Graph"));
+    viewMenu->addAction(performanceAction);
+
+    QAction *sessionAction = sessionDock->toggleViewAction();
+    sessionAction->setText(tr("S&essions"));
+    viewMenu->addAction(sessionAction);
+
     fullScreenAction->setCheckable(true);
     statusBarAction->setCheckable(true);
 
@@ -310,6 +398,9 @@ void MainWindow::createMenu()
                << convertAction
                << downloadAction
                << deleteAction
+               << updateAllAction
+               << exportAction
+               << importAction
                << refreshAction
                << configureAction
                << quitAction;
@@ -353,15 +444,18 @@ void MainWindow::createRomView()
     connect(tableView, SIGNAL(doubleClicked(QModelIndex)), this, SLOT(launchRomFromTable()));
     connect(tableView, SIGNAL(tableActive()), this, SLOT(enableButtons()));
     connect(tableView, SIGNAL(enterPressed()), this, SLOT(launchRomFromTable()));
+    connect(tableView, SIGNAL(currentItemChanged(QTreeWidgetItem*,QTreeWidgetItem*)), this, SLOT(prefetchRom()));
 
     //Create grid view
     gridView = new GridView(this);
     connect(gridView, SIGNAL(gridItemSelected(bool)), this, SLOT(toggleMenus(bool)));
+    connect(gridView, SIGNAL(gridItemSelected(bool)), this, SLOT(prefetchRom()));
 
 
     //Create list view
     listView = new ListView(this);
     connect(listView, SIGNAL(listItemSelected(bool)), this, SLOT(toggleMenus(bool)));
+    connect(listView, SIGNAL(listItemSelected(bool)), this, SLOT(prefetchRom()));
 
 
     //Create disabled view
@@ -411,42 +505,8 @@ void MainWindow::createRomView()
 
 void MainWindow::disableButtons()
 {
-    toggleMenus(false);
-}
-
-
-void MainWindow::disableViews(bool imageUpdated)
-{
-    QString visibleLayout = SETTINGS.value("View/layout", "none").toString();
-
-    //Save position in current layout
-    if (visibleLayout == "table")
-        tableView->saveTablePosition();
-    else if (visibleLayout == "grid")
-        gridView->saveGridPosition();
-    else if (visibleLayout == "list")
-        listView->saveListPosition();
-
-    resetLayouts(imageUpdated);
-    tableView->clear();
-    ddView->clear();
-
-    if (ddAction->isChecked()) { //64DD enabled so show "No Cart" options
-        Rom dummyRom;
-        dummyRom.imageExists = false;
-        tableView->addNoCartRow();
-        gridView->addToGridView(&dummyRom, -1, ddAction->isChecked());
-        listView->addToListView(&dummyRom, -1, ddAction->isChecked());
-        ddView->addNoDiskRow();
-    }
-
-    tableView->setEnabled(false);
-    gridView->setEnabled(false);
-    listView->setEnabled(false);
-    ddView->setEnabled(false);
-
-    foreach (QAction *next, menuRomSelected)
-        next->setEnabled(false);
+    //More games can be started until every session is in use
+    toggleMenus(!emulation->isFull());
 }
 
 
@@ -460,15 +520,25 @@ void MainWindow::enableViews(int romCount, bool cached)
 {
     QString visibleLayout = SETTINGS.value("View/layout", "none").toString();
 
+    scanProgressBar->setHidden(true);
+    scanPauseButton->setHidden(true);
+    scanCancelButton->setHidden(true);
+    statusBar->setVisible(statusBarAction->isChecked());
+
     if (romCount != 0) { //else no ROMs, so leave views disabled
         QStringList tableVisible = SETTINGS.value("Table/columns", "Filename|Size").toString().split("|");
 
-        if (tableVisible.join("") != "")
-            tableView->setEnabled(true);
+        //A game may have been launched during the scan, so leave the views alone while it runs
+        if (!emulation->isFull()) {
+            if (tableVisible.join("") != "")
+                tableView->setEnabled(true);
+            else
+                tableView->setEnabled(false);
 
-        gridView->setEnabled(true);
-        listView->setEnabled(true);
-        ddView->setEnabled(true);
+            gridView->setEnabled(true);
+            listView->setEnabled(true);
+            ddView->setEnabled(true);
+        }
 
         if (visibleLayout == "table")
             tableView->setFocus();
@@ -477,11 +547,9 @@ void MainWindow::enableViews(int romCount, bool cached)
         else if (visibleLayout == "list")
             listView->setFocus();
 
-        //Check if disabled view is showing. If it is, re-enabled the selected view
-        if (!disabledView->isHidden()) {
-            disabledView->setHidden(true);
-            showActiveView();
-        }
+        //Hide the disabled view if it is showing and re-enable the selected view
+        disabledView->setHidden(true);
+        showActiveView();
 
         if (cached) {
             QTimer *timer = new QTimer(this);
@@ -497,6 +565,11 @@ void MainWindow::enableViews(int romCount, bool cached)
                 connect(timer, SIGNAL(timeout()), listView, SLOT(setListPosition()));
         }
     } else {
+        tableView->setEnabled(false);
+        gridView->setEnabled(false);
+        listView->setEnabled(false);
+        ddView->setEnabled(false);
+
         if (visibleLayout != "none") {
             tableView->setHidden(true);
             gridView->setHidden(true);
@@ -572,16 +645,26 @@ QString MainWindow::getCurrentRomInfoFromView(QString infoName)
 }
 
 
-void MainWindow::launchRom(QDir romDir, QString romFileName, QString zipFileName)
+void MainWindow::launchRom(QDir romDir, QString romFileName, QString zipFileName, QString romMD5)
 {
+    //The collection already knows the MD5 and save type, so the ROM doesn't have to be read again
+    QString saveType = "";
+    Rom *rom = romCollection->getRom(romMD5);
+
+    if (rom)
+        saveType = rom->saveType;
+    else
+        romMD5 = "";
+
     if (ddAction->isChecked() && ddView->hasSelectedRom()) {
         QString ddFileName = ddView->getCurrentRomInfo("fileName");
         QString ddDirName = ddView->getCurrentRomInfo("dirName");
         QString ddZipName = ddView->getCurrentRomInfo("zipFile");
 
-        emulation->startEmulator(romDir, romFileName, zipFileName, QDir(ddDirName), ddFileName, ddZipName);
+        emulation->startEmulator(romDir, romFileName, zipFileName, QDir(ddDirName), ddFileName, ddZipName,
+                                 romMD5, saveType);
     } else
-        emulation->startEmulator(romDir, romFileName, zipFileName);
+        emulation->startEmulator(romDir, romFileName, zipFileName, QDir(), "", "", romMD5, saveType);
 }
 
 
@@ -604,8 +687,9 @@ void MainWindow::launchRomFromTable()
         QString romFileName = tableView->getCurrentRomInfo("fileName");
         QString romDirName = tableView->getCurrentRomInfo("dirName");
         QString zipFileName = tableView->getCurrentRomInfo("zipFile");
+        QString romMD5 = tableView->getCurrentRomInfo("romMD5");
 
-        launchRom(QDir(romDirName), romFileName, zipFileName);
+        launchRom(QDir(romDirName), romFileName, zipFileName, romMD5);
     } else {
         launchRom(QDir(), "", "");
     }
@@ -617,7 +701,8 @@ void MainWindow::launchRomFromWidget(QWidget *current)
     QString romFileName = current->property("fileName").toString();
     QString romDirName = current->property("directory").toString();
     QString zipFileName = current->property("zipFile").toString();
-    launchRom(QDir(romDirName), romFileName, zipFileName);
+    QString romMD5 = current->property("romMD5").toString();
+    launchRom(QDir(romDirName), romFileName, zipFileName, romMD5);
 }
 
 
@@ -665,14 +750,30 @@ void MainWindow::openDownloader()
 }
 
 
+void MainWindow::openExporter()
+{
+    InfoBundle exporter(InfoBundle::Export, this);
+}
+
+
+void MainWindow::openImporter()
+{
+    InfoBundle importer(InfoBundle::Import, this);
+
+    romCollection->cachedRoms();
+}
+
+
 void MainWindow::openLog()
 {
-    if (emulation->lastOutput == "") {
+    EmulatorLog *log = emulation->getLog();
+
+    if (!log || log->isEmpty()) {
         QMessageBox::information(this, tr("No Output"),
             tr("There is no log. Either <ParentName> has not yet run or there was no output from the last run.")
             .replace("<ParentName>",ParentName));
     } else {
-        LogDialog logDialog(emulation->lastOutput, this);
+        LogDialog logDialog(log, this);
         logDialog.exec();
     }
 }
@@ -683,6 +784,9 @@ void MainWindow::openSettings()
     QString tableImageBefore = SETTINGS.value("Table/imagesize", "Medium").toString();
     QString columnsBefore = SETTINGS.value("Table/columns", "Filename|Size").toString();
     QString downloadBefore = SETTINGS.value("Other/downloadinfo", "").toString();
+    QString scanDepthBefore = SETTINGS.value("Paths/scandepth", -1).toString();
+    QString scanExcludeBefore = SETTINGS.value("Paths/scanexclude", "").toString();
+    QString symlinksBefore = SETTINGS.value("Paths/followsymlinks", "").toString();
 
     SettingsDialog settingsDialog(this, 0);
     settingsDialog.exec();
@@ -690,6 +794,9 @@ void MainWindow::openSettings()
     QString tableImageAfter = SETTINGS.value("Table/imagesize", "Medium").toString();
     QString columnsAfter = SETTINGS.value("Table/columns", "Filename|Size").toString();
     QString downloadAfter = SETTINGS.value("Other/downloadinfo", "").toString();
+    QString scanDepthAfter = SETTINGS.value("Paths/scandepth", -1).toString();
+    QString scanExcludeAfter = SETTINGS.value("Paths/scanexclude", "").toString();
+    QString symlinksAfter = SETTINGS.value("Paths/followsymlinks", "").toString();
 
     //Reset columns widths if user has selected different columns to display
     if (columnsBefore != columnsAfter) {
@@ -702,6 +809,9 @@ void MainWindow::openSettings()
     if (romCollection->romPaths != romSave) {
         romCollection->updatePaths(romSave);
         romCollection->addRoms();
+    } else if (scanDepthBefore != scanDepthAfter || scanExcludeBefore != scanExcludeAfter ||
+               symlinksBefore != symlinksAfter) {
+        romCollection->addRoms();
     } else if (downloadBefore == "" && downloadAfter == "true") {
         romCollection->addRoms();
     } else {
@@ -719,6 +829,10 @@ void MainWindow::openSettings()
         update64DD();
     }
 
+    updateAllAction->setEnabled(downloadAfter == "true");
+    exportAction->setEnabled(downloadAfter == "true");
+    importAction->setEnabled(downloadAfter == "true");
+
     gridView->setGridBackground();
     listView->setListBackground();
     toggleMenus(true);
@@ -801,6 +915,70 @@ void MainWindow::openZipDialog(QStringList zippedFiles)
 }
 
 
+void MainWindow::prefetchRom()
+{
+    QString visibleLayout = layoutGroup->checkedAction()->data().toString();
+    QWidget *current = nullptr;
+
+    if (visibleLayout == "table" && tableView->hasSelectedRom()) {
+        QString romFileName = tableView->getCurrentRomInfo("fileName");
+        QString romDirName = tableView->getCurrentRomInfo("dirName");
+        QString zipFileName = tableView->getCurrentRomInfo("zipFile");
+
+        emulation->prefetchRom(QDir(romDirName), romFileName, zipFileName);
+        return;
+    } else if (visibleLayout == "grid" && gridView->hasSelectedRom())
+        current = gridView->getCurrentRomWidget();
+    else if (visibleLayout == "list" && listView->hasSelectedRom())
+        current = listView->getCurrentRomWidget();
+
+    if (current) {
+        QString romFileName = current->property("fileName").toString();
+        QString romDirName = current->property("directory").toString();
+        QString zipFileName = current->property("zipFile").toString();
+
+        emulation->prefetchRom(QDir(romDirName), romFileName, zipFileName);
+    } else
+        emulation->cancelPrefetch();
+}
+
+
+void MainWindow::resetViews(bool imageUpdated)
+{
+    QString visibleLayout = SETTINGS.value("View/layout", "none").toString();
+
+    //Save position in current layout
+    if (visibleLayout == "table")
+        tableView->saveTablePosition();
+    else if (visibleLayout == "grid")
+        gridView->saveGridPosition();
+    else if (visibleLayout == "list")
+        listView->saveListPosition();
+
+    resetLayouts(imageUpdated);
+    tableView->clear();
+    ddView->clear();
+
+    if (ddAction->isChecked()) { //64DD enabled so show "No Cart" options
+        Rom dummyRom;
+        dummyRom.imageExists = false;
+        tableView->addNoCartRow();
+        gridView->addToGridView(&dummyRom, -1, 1, ddAction->isChecked());
+        listView->addToListView(&dummyRom, -1, 1, ddAction->isChecked());
+        ddView->addNoDiskRow();
+    }
+
+    //Views stay enabled so ROMs can be launched while a scan adds to them
+    scanProgressBar->setHidden(true);
+    scanPauseButton->setHidden(true);
+    scanCancelButton->setHidden(true);
+    scanPauseButton->setChecked(false);
+
+    foreach (QAction *next, menuRomSelected)
+        next->setEnabled(false);
+}
+
+
 void MainWindow::resetLayouts(bool imageUpdated)
 {
     tableView->resetView(imageUpdated);
@@ -887,6 +1065,27 @@ void MainWindow::showRomMenu(const QPoint &pos)
 }
 
 
+void MainWindow::showSession(EmulatorSession *session)
+{
+    //Keep showing the last graph when nothing is selected, like after a game quits
+    if (!session || session == graphSession)
+        return;
+
+    if (graphSession)
+        disconnect(graphSession->getTelemetry(), SIGNAL(sampleAdded(TelemetrySample)),
+                   performanceGraph, SLOT(addSample(TelemetrySample)));
+
+    graphSession = session;
+    performanceGraph->clear();
+
+    foreach (TelemetrySample sample, session->getTelemetry()->getSamples())
+        performanceGraph->addSample(sample);
+
+    connect(session->getTelemetry(), SIGNAL(sampleAdded(TelemetrySample)),
+            performanceGraph, SLOT(addSample(TelemetrySample)));
+}
+
+
 void MainWindow::stopEmulator()
 {
     emulation->stopEmulator();
@@ -899,7 +1098,7 @@ void MainWindow::toggleMenus(bool active)
         next->setEnabled(active);
 
     foreach (QAction *next, menuDisable)
-        next->setEnabled(!active);
+        next->setEnabled(!active || emulation->isRunning());
 
     tableView->setEnabled(active);
     gridView->setEnabled(active);
@@ -917,6 +1116,9 @@ void MainWindow::toggleMenus(bool active)
     if (SETTINGS.value("Other/downloadinfo", "").toString() == "") {
         downloadAction->setEnabled(false);
         deleteAction->setEnabled(false);
+        updateAllAction->setEnabled(false);
+        exportAction->setEnabled(false);
+        importAction->setEnabled(false);
     }
 
     if (SETTINGS.value("Paths/ddiplrom", "").toString() == "")
@@ -964,9 +1166,10 @@ void MainWindow::updateLayoutSetting()
     disabledView->setHidden(true);
     ddView->setHidden(true);
 
-    int romCount = romCollection->cachedRoms();
+    //The selected view is shown by enableViews once the ROMs are loaded
+    romCollection->cachedRoms();
 
-    if (romCount > 0 || visibleLayout == "none")
+    if (visibleLayout == "none")
         showActiveView();
 
     //Don't show 64DD panel for empty view
@@ -1004,6 +1207,38 @@ void MainWindow::update64DD()
 }
 
 
+void MainWindow::updateRomInView(Rom *currentRom)
+{
+    QString visibleLayout = SETTINGS.value("View/layout", "none").toString();
+
+    if (visibleLayout == "table")
+        tableView->updateRom(currentRom);
+    else if (visibleLayout == "grid")
+        gridView->updateRom(currentRom);
+    else if (visibleLayout == "list")
+        listView->updateRom(currentRom);
+}
+
+
+void MainWindow::updateScanProgress(int value, int maximum)
+{
+    if (scanProgressBar->isHidden()) {
+        statusBar->show();
+        scanProgressBar->setHidden(false);
+        scanPauseButton->setHidden(false);
+        scanCancelButton->setHidden(false);
+    }
+
+    scanProgressBar->setMaximum(maximum);
+    scanProgressBar->setValue(value);
+
+    //Still searching the ROM directories, so there's only a count to show. The scanner
+    //refreshes this while it searches, so let it time out on its own afterwards
+    if (maximum == 0)
+        statusBar->showMessage(tr("Searching ROM directories: %1 files found").arg(value), 1000);
+}
+
+
 void MainWindow::updateStatusBar(QString message, int timeout)
 {
     statusBar->showMessage(message, timeout);
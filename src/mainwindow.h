@@ -33,15 +33,19 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include <QPointer>
 
 class QActionGroup;
 class QDialogButtonBox;
 class QDir;
+class QDockWidget;
 class QHeaderView;
 class QGridLayout;
 class QLabel;
 class QListWidget;
 class QMenuBar;
+class QProgressBar;
+class QPushButton;
 class QScrollArea;
 class QSplitter;
 class QStatusBar;
@@ -49,9 +53,12 @@ class QTreeWidget;
 class QVBoxLayout;
 class DDView;
 class EmulatorHandler;
+class EmulatorSession;
 class GridView;
 class ListView;
+class PerformanceGraph;
 class RomCollection;
+class SessionList;
 class TableView;
 class TheGamesDBScraper;
 class TreeWidgetItem;
@@ -72,7 +79,7 @@ protected:
 private:
     void createMenu();
     void createRomView();
-    void launchRom(QDir romDir, QString romFileName, QString zipFileName);
+    void launchRom(QDir romDir, QString romFileName, QString zipFileName, QString romMD5 = "");
     void openZipDialog(QStringList zippedFiles);
     void resetLayouts(bool imageUpdated = false);
     void restoreSplitterSize();
@@ -86,7 +93,9 @@ private:
     QAction *convertAction;
     QAction *deleteAction;
     QAction *downloadAction;
+    QAction *exportAction;
     QAction *fullScreenAction;
+    QAction *importAction;
     QAction *logAction;
     QAction *ddAction;
     QAction *openAction;
@@ -95,9 +104,12 @@ private:
     QAction *startAction;
     QAction *statusBarAction;
     QAction *stopAction;
+    QAction *updateAllAction;
     QActionGroup *layoutGroup;
     QDialog *zipDialog;
     QDialogButtonBox *zipButtonBox;
+    QDockWidget *performanceDock;
+    QDockWidget *sessionDock;
     QGridLayout *emptyLayout;
     QGridLayout *zipLayout;
     QHeaderView *ddHeaderView;
@@ -115,6 +127,9 @@ private:
     QMenu *settingsMenu;
     QMenu *viewMenu;
     QMenuBar *menuBar;
+    QProgressBar *scanProgressBar;
+    QPushButton *scanCancelButton;
+    QPushButton *scanPauseButton;
     QScrollArea *emptyView;
     QSplitter *viewSplitter;
     QStatusBar *statusBar;
@@ -127,15 +142,17 @@ private:
     DDView *ddView;
     GridView *gridView;
     ListView *listView;
+    PerformanceGraph *performanceGraph;
+    QPointer<EmulatorSession> graphSession;
     RomCollection *romCollection;
+    SessionList *sessionList;
     TableView *tableView;
     TheGamesDBScraper *scraper;
     TreeWidgetItem *fileItem;
 
 private slots:
-    void addToView(Rom *currentRom, int count);
+    void addToView(Rom *roms, int first, int count);
     void disableButtons();
-    void disableViews(bool imageUpdated);
     void enableButtons();
     void enableViews(int romCount, bool cached);
     void launchRomFromMenu();
@@ -146,16 +163,23 @@ private slots:
     void openConverter();
     void openDeleteDialog();
     void openDownloader();
+    void openExporter();
+    void openImporter();
     void openLog();
     void openSettings();
     void openRom();
+    void prefetchRom();
+    void resetViews(bool imageUpdated);
     void showMenuBar(bool mouseAtTop);
     void showRomMenu(const QPoint &);
+    void showSession(EmulatorSession *session);
     void stopEmulator();
     void toggleMenus(bool active);
     void update64DD();
     void updateFullScreenMode();
     void updateLayoutSetting();
+    void updateRomInView(Rom *currentRom);
+    void updateScanProgress(int value, int maximum);
     void updateStatusBar(QString message, int timeout);
     void updateStatusBarView();
 
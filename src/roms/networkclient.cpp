@@ -0,0 +1,185 @@
+/***
+ * Copyright (c) 2013, Dan Hasting
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "networkclient.h"
+
+#include "../global.h"
+#include "../common.h"
+
+#include <QCoreApplication>
+#include <QStringList>
+
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkDiskCache>
+#include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QNetworkRequest>
+
+
+NetworkClient::NetworkClient(QObject *parent) : QObject(parent)
+{
+    cacheHits = 0;
+    handshakes = 0;
+    http2Replies = 0;
+    requests = 0;
+    responseHits = 0;
+    responseLookups = 0;
+
+    responses.setMaxCost(4 * 1024 * 1024);
+
+    //Replies with an ETag or Last-Modified are revalidated by Qt and a 304 is served from disk
+    QNetworkDiskCache *diskCache = new QNetworkDiskCache;
+    diskCache->setCacheDirectory(getCacheLocation() + "http");
+    diskCache->setMaximumCacheSize(SETTINGS.value("Other/httpcachesize", 50).toLongLong() * 1024 * 1024);
+
+    manager = new QNetworkAccessManager(this);
+    manager->setCache(diskCache);
+}
+
+
+NetworkClient *NetworkClient::instance()
+{
+    //Owned by the application so the connection pool lives for the whole session
+    static NetworkClient *client = nullptr;
+
+    if (client == nullptr)
+        client = new NetworkClient(QCoreApplication::instance());
+
+    return client;
+}
+
+
+void NetworkClient::connectionEncrypted()
+{
+    //Only emitted after a handshake, so requests reusing an open connection don't count. Qt doesn't
+    //expose its sockets, so plain HTTP connections can't be counted and this is HTTPS only
+    handshakes++;
+}
+
+
+QNetworkReply *NetworkClient::get(QNetworkRequest request)
+{
+    request.setRawHeader("User-Agent", AppName.toUtf8().constData());
+    request.setRawHeader("Connection", "keep-alive");
+
+    //Accept-Encoding is left alone: Qt only inflates gzip replies when it sets the header itself
+#if QT_VERSION >= QT_VERSION_CHECK(5, 9, 0)
+    request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, true);
+#endif
+
+    QNetworkReply *reply = manager->get(request);
+    requests++;
+
+    connect(reply, SIGNAL(encrypted()), this, SLOT(connectionEncrypted()));
+    connect(reply, SIGNAL(finished()), this, SLOT(replyFinished()));
+
+    return reply;
+}
+
+
+NetworkCounters NetworkClient::getCounters()
+{
+    NetworkCounters counters;
+    counters.cacheHits = cacheHits;
+    counters.handshakes = handshakes;
+    counters.http2Replies = http2Replies;
+    counters.requests = requests;
+    counters.responseHits = responseHits;
+    counters.responseLookups = responseLookups;
+
+    return counters;
+}
+
+
+int NetworkClient::getRequests()
+{
+    return requests;
+}
+
+
+QByteArray NetworkClient::getResponse(QString key)
+{
+    responseLookups++;
+
+    QByteArray *data = responses.object(key);
+
+    if (data == nullptr)
+        return QByteArray();
+
+    responseHits++;
+    return *data;
+}
+
+
+QString NetworkClient::getSummary(NetworkCounters before, NetworkCounters after)
+{
+    int runRequests = after.requests - before.requests;
+    int runLookups = after.responseLookups - before.responseLookups;
+
+    QStringList summary;
+
+    if (runRequests > 0)
+        summary << tr("%1 requests, %2 TLS handshakes (%3 over HTTP/2), %4% from disk cache")
+                   .arg(runRequests)
+                   .arg(after.handshakes - before.handshakes)
+                   .arg(after.http2Replies - before.http2Replies)
+                   .arg((after.cacheHits - before.cacheHits) * 100 / runRequests);
+
+    if (runLookups > 0)
+        summary << tr("%1 of %2 queries answered from the response cache")
+                   .arg(after.responseHits - before.responseHits)
+                   .arg(runLookups);
+
+    if (summary.isEmpty())
+        return "";
+
+    return tr("Game information download finished: ") + summary.join(", ");
+}
+
+
+void NetworkClient::replyFinished()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+
+    if (reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool())
+        cacheHits++;
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 9, 0)
+    if (reply->attribute(QNetworkRequest::HTTP2WasUsedAttribute).toBool())
+        http2Replies++;
+#endif
+}
+
+
+void NetworkClient::saveResponse(QString key, QByteArray data)
+{
+    if (!data.isEmpty())
+        responses.insert(key, new QByteArray(data), data.size());
+}
@@ -0,0 +1,85 @@
+/***
+ * Copyright (c) 2013, Dan Hasting
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#ifndef NETWORKCLIENT_H
+#define NETWORKCLIENT_H
+
+#include <QCache>
+#include <QObject>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QNetworkRequest;
+
+
+//Totals since the client was created, a scrape run is the difference between two of these
+struct NetworkCounters {
+    int cacheHits;
+    int handshakes;
+    int http2Replies;
+    int requests;
+    int responseHits;
+    int responseLookups;
+};
+
+class NetworkClient : public QObject
+{
+    Q_OBJECT
+public:
+    static NetworkClient *instance();
+    QNetworkReply *get(QNetworkRequest request);
+    NetworkCounters getCounters();
+    int getRequests();
+    QByteArray getResponse(QString key);
+    static QString getSummary(NetworkCounters before, NetworkCounters after);
+    void saveResponse(QString key, QByteArray data);
+
+private:
+    explicit NetworkClient(QObject *parent = 0);
+
+    int cacheHits;
+    int handshakes;
+    int http2Replies;
+    int requests;
+    int responseHits;
+    int responseLookups;
+
+    QNetworkAccessManager *manager;
+
+    //Raw API responses keyed by the scraper's normalized query, costed in bytes
+    QCache<QString, QByteArray> responses;
+
+private slots:
+    void connectionEncrypted();
+    void replyFinished();
+};
+
+#endif // NETWORKCLIENT_H
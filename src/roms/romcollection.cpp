@@ -32,18 +32,17 @@
 #include "romcollection.h"
 
 #include "../global.h"
-#include "../common.h"
 
+#include "romscanner.h"
 #include "thegamesdbscraper.h"
 
-#include <QCoreApplication>
-#include <QCryptographicHash>
 #include <QDir>
-#include <QJsonDocument>
-#include <QJsonObject>
+#include <QFileSystemWatcher>
 #include <QMessageBox>
-#include <QProgressDialog>
-#include <QTime>
+#include <QSet>
+#include <QStorageInfo>
+#include <QThread>
+#include <QTimer>
 
 #include <QtSql/QSqlQuery>
 
@@ -55,263 +54,151 @@ RomCollection::RomCollection(QStringList fileTypes, QStringList romPaths, QWidge
     this->romPaths.removeAll("");
     this->parent = parent;
 
-    setupDatabase();
-}
-
-
-Rom RomCollection::addRom(QByteArray *romData, QString fileName, QString directory, QString zipFile,
-                          QSqlQuery query, bool ddRom)
-{
-    Rom currentRom;
+    currentScan = NoScan;
+    pendingScan = NoScan;
+    pendingImageUpdated = false;
+    pendingOnStartup = false;
+    restoringCollection = false;
+    reconcileOnLoad = false;
+    updateQueued = false;
+    watchedFilesChanged = false;
+    watchedDirs = this->romPaths;
 
-    currentRom.fileName = fileName;
-    currentRom.directory = directory;
+    qRegisterMetaType<Rom>("Rom");
+    qRegisterMetaType<QVector<Rom> >("QVector<Rom>");
 
-    if (ddRom)
-        currentRom.internalName = "";
-    else
-        currentRom.internalName = QString(romData->mid(32, 20)).trimmed();
-
-    currentRom.romMD5 = QString(QCryptographicHash::hash(*romData,
-                                QCryptographicHash::Md5).toHex());
-    currentRom.zipFile = zipFile;
-    currentRom.sortSize = romData->size();
-
-    query.bindValue(":filename",      currentRom.fileName);
-    query.bindValue(":directory",     currentRom.directory);
-    query.bindValue(":internal_name", currentRom.internalName);
-    query.bindValue(":md5",           currentRom.romMD5);
-    query.bindValue(":zip_file",      currentRom.zipFile);
-    query.bindValue(":size",          currentRom.sortSize);
-
-    if (ddRom)
-        query.bindValue(":dd_rom", 1);
-    else
-        query.bindValue(":dd_rom", 0);
-
-    query.exec();
-
-    if (!ddRom)
-        initializeRom(&currentRom, false);
+    setupDatabase();
 
-    return currentRom;
+    //Scanning and loading run in a separate thread so the views stay usable while ROMs are added
+    scannerThread = new QThread(this);
+    scanner = new RomScanner(fileTypes);
+    scanner->moveToThread(scannerThread);
+
+    connect(scannerThread, SIGNAL(finished()), scanner, SLOT(deleteLater()));
+    connect(scanner, SIGNAL(romsFound(QVector<Rom>)), this, SLOT(addScannedRoms(QVector<Rom>)));
+    connect(scanner, SIGNAL(ddRomsFound(QVector<Rom>)), this, SLOT(addScannedDDRoms(QVector<Rom>)));
+    connect(scanner, SIGNAL(scanWarning(QString)), this, SLOT(addScanWarning(QString)));
+    connect(scanner, SIGNAL(fullScanStarted()), this, SLOT(fullScanStarted()));
+    connect(scanner, SIGNAL(progressUpdate(int, int)), this, SIGNAL(scanProgress(int, int)));
+    connect(scanner, SIGNAL(finished(bool, bool)), this, SLOT(scanFinished(bool, bool)));
+    connect(scanner, SIGNAL(filesRemoved(QStringList)), this, SLOT(removeScannedFiles(QStringList)));
+    connect(scanner, SIGNAL(directoriesFound(QStringList)), this, SLOT(watchDirectories(QStringList)));
+
+    scannerThread->start();
+
+    //Game information is downloaded in the background, separate from the scan
+    scraper = new TheGamesDBScraper();
+
+    connect(scanner, SIGNAL(gameInfoNeeded(QString, QString)), scraper, SLOT(queueGameInfo(QString, QString)));
+    connect(scraper, SIGNAL(gameInfoReady(QString)), this, SLOT(updateGameInfo(QString)));
+    connect(scraper, SIGNAL(scrapeError(QString)), this, SLOT(scrapeFailed(QString)));
+    connect(scraper, SIGNAL(statusUpdate(QString, int)), this, SIGNAL(statusUpdate(QString, int)));
+
+    //Pick up files added to the ROM directories without needing a full refresh.
+    //Events come in bursts while files are copied, so wait for them to stop first
+    watcher = new QFileSystemWatcher(this);
+    updateTimer = new QTimer(this);
+    updateTimer->setSingleShot(true);
+    updateTimer->setInterval(1000);
+    pollTimer = new QTimer(this);
+
+    connect(watcher, SIGNAL(directoryChanged(QString)), updateTimer, SLOT(start()));
+    connect(scanner, SIGNAL(filesSettling()), updateTimer, SLOT(start()));
+    connect(updateTimer, SIGNAL(timeout()), this, SLOT(updateRoms()));
+    connect(pollTimer, SIGNAL(timeout()), this, SLOT(updateRoms()));
+
+    setupWatcher();
 }
 
 
-int RomCollection::addRoms()
+RomCollection::~RomCollection()
 {
-    emit updateStarted();
+    scanner->cancel();
+    scannerThread->quit();
+    scannerThread->wait();
 
-    //Count files so we know how to setup the progress dialog
-    int totalCount = 0;
-
-    foreach (QString romPath, romPaths) {
-        QDir romDir(romPath);
-
-        if (romDir.exists()) {
-            QStringList files = scanDirectory(romDir);
-            totalCount += files.size();
-        }
-    }
-
-    QList<Rom> roms;
-    QList<Rom> ddRoms;
-
-    database.open();
-    QSqlQuery query("DELETE FROM rom_collection", database);
-
-    if (totalCount != 0) {
-        int count = 0;
-        setupProgressDialog(totalCount);
-
-        query.prepare(QString("INSERT INTO rom_collection ")
-                      + "(filename, directory, internal_name, md5, zip_file, size, dd_rom) "
-                      + "VALUES (:filename, :directory, :internal_name, :md5, :zip_file, :size, :dd_rom)");
-
-        scraper = new TheGamesDBScraper(parent);
-
-        foreach (QString romPath, romPaths)
-        {
-            QDir romDir(romPath);
-            QStringList files = scanDirectory(romDir);
-
-            int romCount = 0;
-
-            foreach (QString fileName, files)
-            {
-                QString completeFileName = romDir.absoluteFilePath(fileName);
-                QFile file(completeFileName);
-
-                //If file is a zip file, extract info from any zipped ROMs
-                if (QFileInfo(file).suffix().toLower() == "zip") {
-                    foreach (QString zippedFile, getZippedFiles(completeFileName))
-                    {
-                        //check for ROM files
-                        QByteArray *romData = getZippedRom(zippedFile, completeFileName);
-
-                        if (fileTypes.contains("*.v64"))
-                            *romData = byteswap(*romData);
-
-                        if (romData->left(4).toHex() == "80371240") { //Z64 ROM
-                            roms.append(addRom(romData, zippedFile, romPath, fileName, query));
-                            romCount++;
-                        } else if (romData->left(4).toHex() == "e848d316") { //64DD ROM
-                            ddRoms.append(addRom(romData, zippedFile, romPath, fileName, query, true));
-                            romCount++;
-                        }
-
-                        delete romData;
-                    }
-                } else { //Just a normal file
-                    file.open(QIODevice::ReadOnly);
-                    QByteArray *romData = new QByteArray(file.readAll());
-                    file.close();
-
-                    if (fileTypes.contains("*.v64"))
-                        *romData = byteswap(*romData);
-
-                    if (romData->left(4).toHex() == "80371240") { //Z64 ROM
-                        roms.append(addRom(romData, fileName, romPath, "", query));
-                        romCount++;
-                    } else if (romData->left(4).toHex() == "e848d316") { //64DD ROM
-                        ddRoms.append(addRom(romData, fileName, romPath, "", query, true));
-                        romCount++;
-                    }
-
-                    delete romData;
-                }
-
-                count++;
-                progress->setValue(count);
-                QCoreApplication::processEvents(QEventLoop::AllEvents);
-            }
-
-            if (romCount == 0)
-                QMessageBox::warning(parent, tr("Warning"), tr("No ROMs found in ") + romPath + ".");
-        }
-
-        delete scraper;
-        progress->close();
-    } else if (romPaths.size() != 0) {
-        QMessageBox::warning(parent, tr("Warning"), tr("No ROMs found."));
-    }
-
-    database.close();
+    delete scraper;
+}
 
-    //Emit signals for regular roms
-    std::sort(roms.begin(), roms.end(), romSorter);
 
-    for (int i = 0; i < roms.size(); i++)
-        emit romAdded(&roms[i], i);
+void RomCollection::addRoms()
+{
+    startScan(FullScan);
+}
 
-    //Emit signals for 64DD roms
-    std::sort(ddRoms.begin(), ddRoms.end(), romSorter);
 
-    for (int i = 0; i < ddRoms.size(); i++)
-        emit ddRomAdded(&ddRoms[i]);
+void RomCollection::addScannedDDRoms(QVector<Rom> foundRoms)
+{
+    int first = ddRoms.size();
+    ddRoms += foundRoms;
 
-    emit updateEnded(roms.size());
+    if (currentScan == UpdateScan)
+        watchedFilesChanged = true;
 
-    return roms.size();
+    if (currentScan == FullScan)
+        emit ddRomsAdded(ddRoms.data() + first, foundRoms.size());
 }
 
 
-int RomCollection::cachedRoms(bool imageUpdated, bool onStartup)
+void RomCollection::addScannedRoms(QVector<Rom> foundRoms)
 {
-    emit updateStarted(imageUpdated);
+    int first = roms.size();
+    roms += foundRoms;
 
-    database.open();
-    QSqlQuery query(QString("SELECT filename, directory, md5, internal_name, zip_file, size, dd_rom ")
-                    + "FROM rom_collection", database);
+    if (currentScan == UpdateScan)
+        watchedFilesChanged = true;
 
-    query.last();
-    int romCount = query.at() + 1;
-    query.seek(-1);
+    //Stream new ROMs to the views during a full scan. Cached loads are fast, so wait and sort them first
+    if (currentScan == FullScan)
+        emit romsAdded(roms.data() + first, first, foundRoms.size());
+}
 
-    if (romCount == -1) //Nothing cached so try adding ROMs instead
-        return addRoms();
 
+void RomCollection::addScanWarning(QString message)
+{
+    scanWarnings << message;
+}
 
-    //Check if user has data from TheGamesDB API v1 and update them to v2 data
-    if (onStartup) {
-        bool onV1 = false;
-        QDir cacheDir(getCacheLocation());
 
-        if (!cacheDir.exists() && SETTINGS.value("Other/downloadinfo", "").toString() == "true")
-            onV1 = true;
+void RomCollection::cachedRoms(bool imageUpdated, bool onStartup)
+{
+    //A full scan is still running, so rebuild the views from what has been found so far
+    if (currentScan == FullScan && pendingScan == NoScan) {
+        emit updateStarted(imageUpdated);
+        emit romsAdded(roms.data(), 0, roms.size());
+        emit ddRomsAdded(ddRoms.data(), ddRoms.size());
 
-        if (onV1)
-            return addRoms();
+        return;
     }
 
+    startScan(CachedScan, imageUpdated, onStartup);
+}
 
-    QList<Rom> roms;
-    QList<Rom> ddRoms;
-
-    int count = 0;
-    bool showProgress = false;
-    QTime checkPerformance;
-
-    while (query.next())
-    {
-        Rom currentRom;
-
-        currentRom.fileName = query.value(0).toString();
-        currentRom.directory = query.value(1).toString();
-        currentRom.romMD5 = query.value(2).toString();
-        currentRom.internalName = query.value(3).toString();
-        currentRom.zipFile = query.value(4).toString();
-        currentRom.sortSize = query.value(5).toInt();
-        int ddRom = query.value(6).toInt();
-
-        //Check performance of adding first item to see if progress dialog needs to be shown
-        if (count == 0) checkPerformance.start();
-
-        if (ddRom == 1)
-            ddRoms.append(currentRom);
-        else {
-            initializeRom(&currentRom, true);
-            roms.append(currentRom);
-        }
-
-        if (count == 0) {
-            int runtime = checkPerformance.elapsed();
-
-            //check if operation expected to take longer than two seconds
-            if (runtime * romCount > 2000) {
-                setupProgressDialog(romCount);
-                showProgress = true;
-            }
-        }
-
-        count++;
 
-        if (showProgress) {
-            progress->setValue(count);
-            QCoreApplication::processEvents(QEventLoop::AllEvents);
-        }
-    }
+void RomCollection::cancelScan()
+{
+    pendingScan = NoScan;
 
-    database.close();
+    if (currentScan != NoScan)
+        scanner->cancel();
+}
 
-    if (showProgress)
-        progress->close();
 
+void RomCollection::emitRoms()
+{
     //Emit signals for regular roms
     std::sort(roms.begin(), roms.end(), romSorter);
-
-    for (int i = 0; i < roms.size(); i++)
-        emit romAdded(&roms[i], i);
+    emit romsAdded(roms.data(), 0, roms.size());
 
     //Emit signals for 64DD roms
     std::sort(ddRoms.begin(), ddRoms.end(), romSorter);
+    emit ddRomsAdded(ddRoms.data(), ddRoms.size());
+}
 
-    for (int i = 0; i < ddRoms.size(); i++)
-        emit ddRomAdded(&ddRoms[i]);
-
-    emit updateEnded(roms.size(), true);
 
-    return roms.size();
+void RomCollection::fullScanStarted()
+{
+    currentScan = FullScan;
 }
 
 
@@ -326,135 +213,178 @@ QStringList RomCollection::getFileTypes(bool archives)
 }
 
 
-void RomCollection::initializeRom(Rom *currentRom, bool cached)
+Rom *RomCollection::getRom(QString romMD5)
 {
-    QSettings *romCatalog = new QSettings(parent);
+    if (romMD5 == "")
+        return nullptr;
 
-    QString catalogFile = SETTINGS.value("Paths/catalog", "").toString();
-    if (catalogFile == "") {
-        QString dataPath = SETTINGS.value("Paths/data", "").toString();
-        QDir dataDir(dataPath);
-
-        if (QFileInfo(dataDir.absoluteFilePath("mupen64plus.ini")).exists())
-            catalogFile = dataDir.absoluteFilePath("mupen64plus.ini");
+    for (int i = 0; i < roms.size(); i++)
+    {
+        if (roms[i].romMD5 == romMD5.toUpper())
+            return &roms[i];
     }
 
-    QDir romDir(currentRom->directory);
+    return nullptr;
+}
 
-    //Default text for GoodName to notify user
-    currentRom->goodName = getTranslation("Requires catalog file");
-    currentRom->imageExists = false;
 
-    bool getGoodName = false;
-    if (QFileInfo(catalogFile).exists()) {
-        romCatalog = new QSettings(catalogFile, QSettings::IniFormat, parent);
-        getGoodName = true;
-    }
+bool RomCollection::isScanning()
+{
+    return currentScan != NoScan;
+}
 
-    QFile file(romDir.absoluteFilePath(currentRom->fileName));
 
-    currentRom->romMD5 = currentRom->romMD5.toUpper();
-    currentRom->baseName = QFileInfo(file).completeBaseName();
-    currentRom->size = QObject::tr("%1 MB").arg((currentRom->sortSize + 1023) / 1024 / 1024);
+void RomCollection::pauseScan(bool paused)
+{
+    scanner->setPaused(paused);
+}
 
-    if (getGoodName) {
-        //Join GoodName on ", ", otherwise entries with a comma won't show
-        QVariant gNameRaw = romCatalog->value(currentRom->romMD5+"/GoodName",getTranslation("Unknown ROM"));
-        currentRom->goodName = gNameRaw.toStringList().join(", ");
 
-        QStringList CRC = romCatalog->value(currentRom->romMD5+"/CRC","").toString().split(" ");
+void RomCollection::refreshGameInfo()
+{
+    QStringList identifiers, searchNames;
 
-        if (CRC.size() == 2) {
-            currentRom->CRC1 = CRC[0];
-            currentRom->CRC2 = CRC[1];
-        }
+    for (int i = 0; i < roms.size(); i++)
+    {
+        identifiers << roms.at(i).romMD5;
+        searchNames << getSearchName(&roms.at(i));
+    }
 
-        QString newMD5 = romCatalog->value(currentRom->romMD5+"/RefMD5","").toString();
-        if (newMD5 == "")
-            newMD5 = currentRom->romMD5;
+    scraper->refreshGameInfo(identifiers, searchNames);
+}
 
-        currentRom->players = romCatalog->value(newMD5+"/Players","").toString();
-        currentRom->saveType = romCatalog->value(newMD5+"/SaveType","").toString();
-        currentRom->rumble = romCatalog->value(newMD5+"/Rumble","").toString();
-    }
 
-    if (!cached && SETTINGS.value("Other/downloadinfo", "").toString() == "true") {
-        if (currentRom->goodName != getTranslation("Unknown ROM") &&
-            currentRom->goodName != getTranslation("Requires catalog file")) {
-            scraper->downloadGameInfo(currentRom->romMD5, currentRom->goodName);
-        } else {
-            //tweak internal name by adding spaces to get better results
-            QString search = currentRom->internalName;
-            search.replace(QRegExp("([a-z])([A-Z])"),"\\1 \\2");
-            search.replace(QRegExp("([^ \\d])(\\d)"),"\\1 \\2");
-            scraper->downloadGameInfo(currentRom->romMD5, search);
-        }
+void RomCollection::removeScannedFiles(QStringList files)
+{
+    QSet<QString> removed = files.toSet();
+
+    for (int i = roms.size() - 1; i >= 0; i--)
+    {
+        QString file = roms.at(i).zipFile == "" ? roms.at(i).fileName : roms.at(i).zipFile;
 
+        if (removed.contains(roms.at(i).directory + "/" + file)) {
+            roms.remove(i);
+            watchedFilesChanged = true;
+        }
     }
 
-    if (SETTINGS.value("Other/downloadinfo", "").toString() == "true") {
-        QString dataFile = getCacheLocation() + currentRom->romMD5.toLower() + "/data.json";
-        QFile file(dataFile);
+    for (int i = ddRoms.size() - 1; i >= 0; i--)
+    {
+        QString file = ddRoms.at(i).zipFile == "" ? ddRoms.at(i).fileName : ddRoms.at(i).zipFile;
 
-        file.open(QIODevice::ReadOnly);
-        QString data = file.readAll();
-        file.close();
+        if (removed.contains(ddRoms.at(i).directory + "/" + file)) {
+            ddRoms.remove(i);
+            watchedFilesChanged = true;
+        }
+    }
+}
 
-        QJsonDocument document = QJsonDocument::fromJson(data.toUtf8());
-        QJsonObject json = document.object();
 
-        //Remove any non-standard characters
-        QString regex = "[^A-Za-z 0-9 \\.,\\?'""!@#\\$%\\^&\\*\\(\\)-_=\\+;:<>\\/\\\\|\\}\\{\\[\\]`~é]*";
+void RomCollection::scrapeFailed(QString message)
+{
+    //Shown with the other warnings at the end of a scan, otherwise right away
+    if (currentScan != NoScan)
+        scanWarnings << message;
+    else {
+        //Background downloads shouldn't block the window, so don't wait on the dialog
+        QMessageBox *messageBox = new QMessageBox(QMessageBox::Warning, tr("Game Information Download"),
+                                                  message, QMessageBox::Ok, parent);
+        messageBox->setAttribute(Qt::WA_DeleteOnClose);
+        messageBox->setModal(false);
+        messageBox->show();
+    }
+}
 
-        currentRom->gameTitle = json.value("game_title").toString().remove(QRegExp(regex));
-        if (currentRom->gameTitle == "") currentRom->gameTitle = getTranslation("Not found");
 
-        currentRom->releaseDate = json.value("release_date").toString();
-        currentRom->sortDate = json.value("release_date").toString();
-        currentRom->releaseDate.replace(QRegExp("(\\d{4})-(\\d{2})-(\\d{2})"), "\\2/\\3/\\1");
+void RomCollection::scanFinished(bool cached, bool cancelled)
+{
+    ScanType finishedScan = currentScan;
+    currentScan = NoScan;
 
-        currentRom->overview = json.value("overview").toString().remove(QRegExp(regex));
-        currentRom->esrb = json.value("rating").toString();
+    //Another update was requested while this one was running
+    if (pendingScan != NoScan) {
+        ScanType nextScan = pendingScan;
+        pendingScan = NoScan;
 
-        currentRom->genre = json.value("genres").toString();
-        currentRom->publisher = json.value("publisher").toString();
-        currentRom->developer = json.value("developer").toString();
+        startScan(nextScan, pendingImageUpdated, pendingOnStartup);
+        return;
+    }
 
-        foreach (QString ext, QStringList() << "jpg" << "png")
-        {
-            QString imageFile = getCacheLocation() + currentRom->romMD5.toLower() + "/boxart-front." + ext;
-            QFile cover(imageFile);
+    if (finishedScan == UpdateScan) {
+        bool changed = watchedFilesChanged;
+        watchedFilesChanged = false;
+        scanWarnings.clear();
 
-            if (cover.exists() && currentRom->image.load(imageFile)) {
-                currentRom->imageExists = true;
-                break;
+        //Changes are rolled back when cancelled, so reload what is in the database
+        if (cancelled) {
+            if (changed) {
+                restoringCollection = true;
+                startScan(CachedScan);
             }
+        } else if (changed) { //Only touch the views if the update found something
+            emit updateStarted();
+            emitRoms();
+            emit updateEnded(roms.size(), true);
         }
+
+        if (updateQueued && currentScan == NoScan)
+            updateRoms();
+
+        return;
     }
-}
 
+    //Cancelled scans are rolled back, so show the collection as it was before
+    if (cancelled && !cached) {
+        restoringCollection = true;
+        startScan(CachedScan);
+        return;
+    }
 
-QStringList RomCollection::scanDirectory(QDir romDir)
-{
-    QStringList files = romDir.entryList(fileTypes, QDir::Files | QDir::NoSymLinks);
+    //Nothing cached so try adding ROMs instead
+    bool restored = restoringCollection;
+    restoringCollection = false;
 
-    QStringList dirs = romDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks);
-    foreach (QString dir, dirs)
-    {
-        QString subDir = romDir.absolutePath() + "/" + dir;
-        QStringList subFiles = QDir(subDir).entryList(fileTypes, QDir::Files | QDir::NoSymLinks);
-        foreach (QString subFile, subFiles) files << dir + "/" + subFile;
+    if (cached && !cancelled && !restored && roms.isEmpty() && ddRoms.isEmpty()) {
+        startScan(FullScan);
+        return;
     }
 
-    return files;
+    //Files may have changed while the application wasn't running
+    if (finishedScan == CachedScan && reconcileOnLoad && !cancelled &&
+            SETTINGS.value("Other/watchpaths", "true").toString() == "true")
+        updateQueued = true;
+
+    reconcileOnLoad = false;
+
+    if (finishedScan == FullScan) {
+        //ROMs were shown in the order they were found, so only redo the views if that isn't sorted
+        if (!std::is_sorted(roms.begin(), roms.end(), romSorter) ||
+                !std::is_sorted(ddRoms.begin(), ddRoms.end(), romSorter)) {
+            emit updateStarted();
+            emitRoms();
+        }
+    } else
+        emitRoms();
+
+    emit updateEnded(roms.size(), cached);
+
+    if (!scanWarnings.isEmpty() && !cancelled)
+        QMessageBox::warning(parent, tr("Warning"), scanWarnings.join("<br /><br />"));
+
+    scanWarnings.clear();
+
+    //Files changed while the scan was running
+    if (updateQueued)
+        updateRoms();
 }
 
 
 void RomCollection::setupDatabase()
+
 {
     // Bump this when updating rom_collection structure
     // Will cause clients to delete and recreate the table
-    int dbVersion = 2;
+    int dbVersion = 3;
 
     database = QSqlDatabase::addDatabase("QSQLITE");
     database.setDatabaseName(getDataLocation() + "/"+AppNameLower+".sqlite");
@@ -482,22 +412,121 @@ void RomCollection::setupDatabase()
                         + "internal_name TEXT, "
                         + "zip_file TEXT, "
                         + "size INTEGER, "
-                        + "dd_rom INTEGER)");
+                        + "dd_rom INTEGER, "
+                        + "modified INTEGER)");
+
+    //Kept apart from rom_collection so play history survives rebuilding it
+    database.exec(QString()
+                    + "CREATE TABLE IF NOT EXISTS play_sessions ("
+                        + "session_id INTEGER PRIMARY KEY ASC, "
+                        + "md5 TEXT NOT NULL, "
+                        + "emulator TEXT, "
+                        + "args_hash TEXT, "
+                        + "started INTEGER, "
+                        + "ended INTEGER, "
+                        + "exit_code INTEGER, "
+                        + "crashed INTEGER, "
+                        + "samples INTEGER, "
+                        + "vi_mean REAL, "
+                        + "vi_p1 REAL, "
+                        + "mhz_mean REAL, "
+                        + "summary TEXT)");
+    database.exec("CREATE INDEX IF NOT EXISTS play_sessions_md5 ON play_sessions (md5)");
 
     database.close();
 }
 
 
-void RomCollection::setupProgressDialog(int size)
+void RomCollection::setupWatcher()
+{
+    if (!watcher->directories().isEmpty())
+        watcher->removePaths(watcher->directories());
+
+    pollTimer->stop();
+
+    if (SETTINGS.value("Other/watchpaths", "true").toString() != "true")
+        return;
+
+    //Change notifications don't arrive for changes made from other machines on network shares
+    QStringList networkTypes;
+    networkTypes << "nfs" << "nfs4" << "cifs" << "smbfs" << "smb3" << "9p" << "afs" << "fuse.sshfs" << "davfs";
+
+    bool poll = false;
+
+    foreach (QString romPath, romPaths)
+    {
+        //Keep checking so the path is picked up once it becomes available
+        if (!QDir(romPath).exists()) {
+            poll = true;
+            continue;
+        }
+
+        if (networkTypes.contains(QString(QStorageInfo(romPath).fileSystemType()).toLower()))
+            poll = true;
+    }
+
+    //Fails when the system runs out of watches
+    foreach (QString dir, watchedDirs)
+        if (QDir(dir).exists() && !watcher->addPath(dir))
+            poll = true;
+
+    if (poll)
+        pollTimer->start(SETTINGS.value("Other/pollinterval", 60).toInt() * 1000);
+}
+
+
+void RomCollection::startScan(ScanType type, bool imageUpdated, bool onStartup)
 {
-    progress = new QProgressDialog(tr("Loading ROMs..."), tr("Cancel"), 0, size, parent);
-    progress->setWindowFlags(progress->windowFlags() & ~Qt::WindowCloseButtonHint);
-    progress->setWindowFlags(progress->windowFlags() & ~Qt::WindowMinimizeButtonHint);
-    progress->setWindowFlags(progress->windowFlags() & ~Qt::WindowContextHelpButtonHint);
-    progress->setCancelButton(nullptr);
-    progress->setWindowModality(Qt::WindowModal);
-
-    progress->show();
+    //Only one scan runs at a time. Updates wait for the current one to finish,
+    //anything else cancels it and starts when it stops
+    if (currentScan != NoScan && type == UpdateScan) {
+        updateQueued = true;
+        return;
+    }
+
+    if (currentScan != NoScan) {
+        pendingScan = type;
+        pendingImageUpdated = imageUpdated;
+        pendingOnStartup = onStartup;
+
+        scanner->cancel();
+        return;
+    }
+
+    currentScan = type;
+    reconcileOnLoad = type == CachedScan && onStartup;
+    scanner->reset();
+
+    if (type == UpdateScan) {
+        updateQueued = false;
+        QMetaObject::invokeMethod(scanner, "updateRoms", Qt::QueuedConnection, Q_ARG(QStringList, romPaths));
+        return;
+    }
+
+    roms.clear();
+    ddRoms.clear();
+    scanWarnings.clear();
+    watchedFilesChanged = false;
+
+    emit updateStarted(imageUpdated);
+
+    if (type == FullScan)
+        QMetaObject::invokeMethod(scanner, "addRoms", Qt::QueuedConnection, Q_ARG(QStringList, romPaths));
+    else
+        QMetaObject::invokeMethod(scanner, "cachedRoms", Qt::QueuedConnection, Q_ARG(QStringList, romPaths),
+                                  Q_ARG(bool, onStartup));
+}
+
+
+void RomCollection::updateGameInfo(QString identifier)
+{
+    for (int i = 0; i < roms.size(); i++)
+    {
+        if (roms.at(i).romMD5 == identifier) {
+            loadGameInfo(&roms[i]);
+            emit romUpdated(&roms[i]);
+        }
+    }
 }
 
 
@@ -505,4 +534,34 @@ void RomCollection::updatePaths(QStringList romPaths)
 {
     this->romPaths = romPaths;
     this->romPaths.removeAll("");
+
+    watchedDirs = this->romPaths;
+    setupWatcher();
+}
+
+
+void RomCollection::updatePlayHistory(QString romMD5, qint64 time)
+{
+    for (int i = 0; i < roms.size(); i++)
+    {
+        if (roms.at(i).romMD5 == romMD5) {
+            roms[i].lastPlayed = time;
+            roms[i].playCount++;
+            emit romUpdated(&roms[i]);
+        }
+    }
+}
+
+
+void RomCollection::updateRoms()
+{
+    startScan(UpdateScan);
+}
+
+
+void RomCollection::watchDirectories(QStringList dirs)
+{
+    //Subdirectories found by the last walk of the ROM paths
+    watchedDirs = dirs;
+    setupWatcher();
 }
@@ -32,14 +32,18 @@
 #ifndef ROMCOLLECTION_H
 #define ROMCOLLECTION_H
 
+#include "../common.h"
+
 #include <QObject>
 #include <QStringList>
+#include <QVector>
 #include <QtSql/QSqlDatabase>
 
-class QDir;
-class QProgressDialog;
+class QFileSystemWatcher;
+class QThread;
+class QTimer;
+class RomScanner;
 class TheGamesDBScraper;
-struct Rom;
 
 
 class RomCollection : public QObject
@@ -47,37 +51,74 @@ class RomCollection : public QObject
     Q_OBJECT
 public:
     explicit RomCollection(QStringList fileTypes, QStringList romPaths, QWidget *parent = 0);
-    int cachedRoms(bool imageUpdated = false, bool onStartup = false);
+    ~RomCollection();
+    void cachedRoms(bool imageUpdated = false, bool onStartup = false);
+    bool isScanning();
     void updatePaths(QStringList romPaths);
 
     QStringList getFileTypes(bool archives = false);
+    Rom *getRom(QString romMD5);
     QStringList romPaths;
 
 public slots:
-    int addRoms();
+    void addRoms();
+    void cancelScan();
+    void pauseScan(bool paused);
+    void refreshGameInfo();
+    void updatePlayHistory(QString romMD5, qint64 time);
 
 signals:
-    void ddRomAdded(Rom *currentRom);
-    void romAdded(Rom *currentRom, int count);
+    void ddRomsAdded(Rom *roms, int count);
+    void romsAdded(Rom *roms, int first, int count);
+    void romUpdated(Rom *currentRom);
+    void scanProgress(int value, int maximum);
+    void statusUpdate(QString message, int timeout);
     void updateEnded(int romCount, bool cached = false);
     void updateStarted(bool imageUpdated = false);
 
 private:
-    void initializeRom(Rom *currentRom, bool cached);
+    enum ScanType { NoScan, CachedScan, FullScan, UpdateScan };
+
+    void emitRoms();
     void setupDatabase();
-    void setupProgressDialog(int size);
+    void setupWatcher();
+    void startScan(ScanType type, bool imageUpdated = false, bool onStartup = false);
 
-    Rom addRom(QByteArray *romData, QString fileName, QString directory, QString zipFile, QSqlQuery query,
-               bool ddRom = false);
+    bool pendingImageUpdated;
+    bool pendingOnStartup;
+    bool reconcileOnLoad;
+    bool restoringCollection;
+    bool updateQueued;
+    bool watchedFilesChanged;
+    ScanType currentScan;
+    ScanType pendingScan;
 
+    QVector<Rom> roms;
+    QVector<Rom> ddRoms;
     QStringList fileTypes;
-    QStringList scanDirectory(QDir romDir);
+    QStringList scanWarnings;
+    QStringList watchedDirs;
 
     QWidget *parent;
-    QProgressDialog *progress;
     QSqlDatabase database;
-
+    QThread *scannerThread;
+    QTimer *pollTimer;
+    QTimer *updateTimer;
+    QFileSystemWatcher *watcher;
+    RomScanner *scanner;
     TheGamesDBScraper *scraper;
+
+private slots:
+    void addScannedDDRoms(QVector<Rom> foundRoms);
+    void addScannedRoms(QVector<Rom> foundRoms);
+    void addScanWarning(QString message);
+    void fullScanStarted();
+    void removeScannedFiles(QStringList files);
+    void scanFinished(bool cached, bool cancelled);
+    void scrapeFailed(QString message);
+    void updateGameInfo(QString identifier);
+    void updateRoms();
+    void watchDirectories(QStringList dirs);
 };
 
 #endif // ROMCOLLECTION_H
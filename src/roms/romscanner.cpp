@@ -0,0 +1,809 @@
+/***
+ * Copyright (c) 2013, Dan Hasting
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "romscanner.h"
+
+#include "../global.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QMutexLocker>
+#include <QSet>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <QtSql/QSqlQuery>
+
+
+//ROMs are sent to the GUI thread in batches. Flush when either limit is reached
+static const int BatchSize = 100;
+static const int BatchInterval = 250; //ms
+
+//Files changed more recently than this may still be being copied, so updates leave them for later
+static const int SettleTime = 2000; //ms
+
+
+RomScanner::RomScanner(QStringList fileTypes, QObject *parent) : QObject(parent)
+{
+    this->fileTypes = fileTypes;
+
+    cancelled = false;
+    followSymlinks = false;
+    paused = false;
+    scanDepth = -1;
+    walkProgress = false;
+    walksRunning = 0;
+    romCatalog = nullptr;
+}
+
+
+RomScanner::~RomScanner()
+{
+    delete romCatalog;
+}
+
+
+Rom RomScanner::addRom(QByteArray *romData, QString fileName, QString directory, QString zipFile,
+                       QSqlQuery *query, bool ddRom)
+{
+    Rom currentRom;
+
+    currentRom.fileName = fileName;
+    currentRom.directory = directory;
+
+    if (ddRom)
+        currentRom.internalName = "";
+    else
+        currentRom.internalName = QString(romData->mid(32, 20)).trimmed();
+
+    currentRom.romMD5 = QString(QCryptographicHash::hash(*romData,
+                                QCryptographicHash::Md5).toHex());
+    currentRom.zipFile = zipFile;
+    currentRom.sortSize = romData->size();
+    currentRom.imageExists = false;
+
+    query->bindValue(":filename",      currentRom.fileName);
+    query->bindValue(":directory",     currentRom.directory);
+    query->bindValue(":internal_name", currentRom.internalName);
+    query->bindValue(":md5",           currentRom.romMD5);
+    query->bindValue(":zip_file",      currentRom.zipFile);
+    query->bindValue(":size",          currentRom.sortSize);
+
+    if (ddRom)
+        query->bindValue(":dd_rom", 1);
+    else
+        query->bindValue(":dd_rom", 0);
+
+    query->exec();
+
+    if (!ddRom)
+        initializeRom(&currentRom, false);
+
+    return currentRom;
+}
+
+
+int RomScanner::addFile(QString romPath, QString fileName, QSqlQuery *query)
+{
+    QDir romDir(romPath);
+    int romCount = 0;
+
+    QString completeFileName = romDir.absoluteFilePath(fileName);
+    QFile file(completeFileName);
+
+    //Stored so later updates can tell if the file has changed
+    query->bindValue(":modified", QFileInfo(file).lastModified().toMSecsSinceEpoch());
+
+    //If file is a zip file, extract info from any zipped ROMs
+    if (QFileInfo(file).suffix().toLower() == "zip") {
+        foreach (QString zippedFile, getZippedFiles(completeFileName))
+        {
+            //check for ROM files
+            QByteArray *romData = getZippedRom(zippedFile, completeFileName);
+
+            if (fileTypes.contains("*.v64"))
+                *romData = byteswap(*romData);
+
+            if (romData->left(4).toHex() == "80371240") { //Z64 ROM
+                queueRom(addRom(romData, zippedFile, romPath, fileName, query));
+                romCount++;
+            } else if (romData->left(4).toHex() == "e848d316") { //64DD ROM
+                queueRom(addRom(romData, zippedFile, romPath, fileName, query, true), true);
+                romCount++;
+            }
+
+            delete romData;
+        }
+    } else { //Just a normal file
+        file.open(QIODevice::ReadOnly);
+        QByteArray *romData = new QByteArray(file.readAll());
+        file.close();
+
+        if (fileTypes.contains("*.v64"))
+            *romData = byteswap(*romData);
+
+        if (romData->left(4).toHex() == "80371240") { //Z64 ROM
+            queueRom(addRom(romData, fileName, romPath, "", query));
+            romCount++;
+        } else if (romData->left(4).toHex() == "e848d316") { //64DD ROM
+            queueRom(addRom(romData, fileName, romPath, "", query, true), true);
+            romCount++;
+        }
+
+        delete romData;
+    }
+
+    return romCount;
+}
+
+
+void RomScanner::addRoms(QStringList romPaths)
+{
+    emit fullScanStarted();
+
+    //Keep the old collection until the scan completes so a cancelled scan can be rolled back
+    openDatabase();
+    database.transaction();
+    QSqlQuery query("DELETE FROM rom_collection", database);
+
+    prepareInsert(&query);
+
+    loadCatalog();
+    loadPlayHistory();
+    //Files are loaded as the directory walk finds them, so the tree is only listed once
+    startWalks(romPaths, true);
+
+    QVector<int> romCounts(romPaths.size(), 0);
+    int count = 0, root;
+    QString fileName;
+
+    while (keepScanning() && nextFile(&root, &fileName))
+    {
+        romCounts[root] += addFile(romPaths.at(root), fileName, &query);
+        count++;
+
+        //The total is only known once the walk is done, until then just show activity
+        if (walking())
+            emit progressUpdate(filesFound.load(), 0);
+        else
+            emit progressUpdate(count, filesFound.load());
+    }
+
+    finishWalks();
+    flushRoms();
+
+    if (!isCancelled()) {
+        if (count == 0 && romPaths.size() != 0)
+            emit scanWarning(tr("No ROMs found."));
+        else
+            for (int i = 0; i < romPaths.size(); i++)
+                if (romCounts.at(i) == 0)
+                    emit scanWarning(tr("No ROMs found in ") + romPaths.at(i) + ".");
+    }
+
+    bool wasCancelled = isCancelled();
+
+    query.finish();
+
+    if (wasCancelled)
+        database.rollback();
+    else
+        database.commit();
+
+    database.close();
+
+    emit finished(false, wasCancelled);
+}
+
+
+void RomScanner::cachedRoms(QStringList romPaths, bool onStartup)
+{
+    openDatabase();
+    QSqlQuery query(QString("SELECT filename, directory, md5, internal_name, zip_file, size, dd_rom ")
+                    + "FROM rom_collection ORDER BY filename", database);
+
+    query.last();
+    int romCount = query.at() + 1;
+    query.seek(-1);
+
+    if (romCount <= 0) { //Nothing cached, RomCollection will try adding ROMs instead
+        query.finish();
+        database.close();
+
+        emit finished(true, isCancelled());
+        return;
+    }
+
+
+    //Check if user has data from TheGamesDB API v1 and update them to v2 data
+    if (onStartup) {
+        bool onV1 = false;
+        QDir cacheDir(getCacheLocation());
+
+        if (!cacheDir.exists() && SETTINGS.value("Other/downloadinfo", "").toString() == "true")
+            onV1 = true;
+
+        if (onV1) {
+            query.finish();
+            addRoms(romPaths);
+            return;
+        }
+    }
+
+
+    loadCatalog();
+    loadPlayHistory();
+
+    int count = 0;
+    bool showProgress = false;
+    QElapsedTimer checkPerformance;
+
+    while (query.next())
+    {
+        if (!keepScanning())
+            break;
+
+        Rom currentRom;
+
+        currentRom.fileName = query.value(0).toString();
+        currentRom.directory = query.value(1).toString();
+        currentRom.romMD5 = query.value(2).toString();
+        currentRom.internalName = query.value(3).toString();
+        currentRom.zipFile = query.value(4).toString();
+        currentRom.sortSize = query.value(5).toInt();
+        currentRom.imageExists = false;
+        int ddRom = query.value(6).toInt();
+
+        //Check performance of adding first item to see if progress needs to be shown
+        if (count == 0) checkPerformance.start();
+
+        if (ddRom == 1)
+            queueRom(currentRom, true);
+        else {
+            initializeRom(&currentRom, true);
+            queueRom(currentRom);
+        }
+
+        if (count == 0) {
+            qint64 runtime = checkPerformance.elapsed();
+
+            //check if operation expected to take longer than two seconds
+            if (runtime * romCount > 2000)
+                showProgress = true;
+        }
+
+        count++;
+
+        if (showProgress)
+            emit progressUpdate(count, romCount);
+    }
+
+    flushRoms();
+
+    query.finish();
+    database.close();
+
+    emit finished(true, isCancelled());
+}
+
+
+void RomScanner::cancel()
+{
+    QMutexLocker locker(&stateMutex);
+    cancelled = true;
+    pauseCondition.wakeAll();
+}
+
+
+void RomScanner::endWalk(int root, QStringList dirs)
+{
+    QMutexLocker locker(&queueMutex);
+    walkedDirs[root] = dirs;
+    walksRunning--;
+    queueCondition.wakeAll();
+}
+
+
+void RomScanner::finishWalks()
+{
+    //Walks stop early once the scan is cancelled
+    foreach (QFuture<void> walk, walks)
+        walk.waitForFinished();
+
+    walks.clear();
+    workQueue.clear();
+
+    QStringList dirs;
+
+    foreach (QStringList walked, walkedDirs)
+        dirs += walked;
+
+    if (!isCancelled())
+        emit directoriesFound(dirs);
+}
+
+
+void RomScanner::flushRoms()
+{
+    if (!foundRoms.isEmpty()) {
+        emit romsFound(foundRoms);
+        foundRoms.clear();
+    }
+
+    if (!foundDDRoms.isEmpty()) {
+        emit ddRomsFound(foundDDRoms);
+        foundDDRoms.clear();
+    }
+
+    for (int i = 0; i < neededInfo.size(); i++)
+        emit gameInfoNeeded(neededInfo.at(i).first, neededInfo.at(i).second);
+
+    neededInfo.clear();
+}
+
+
+void RomScanner::initializeRom(Rom *currentRom, bool cached)
+{
+    QDir romDir(currentRom->directory);
+
+    //Default text for GoodName to notify user
+    currentRom->goodName = getTranslation("Requires catalog file");
+    currentRom->imageExists = false;
+
+    QFile file(romDir.absoluteFilePath(currentRom->fileName));
+
+    currentRom->romMD5 = currentRom->romMD5.toUpper();
+    currentRom->baseName = QFileInfo(file).completeBaseName();
+    currentRom->size = QObject::tr("%1 MB").arg((currentRom->sortSize + 1023) / 1024 / 1024);
+
+    if (romCatalog != nullptr) {
+        //Join GoodName on ", ", otherwise entries with a comma won't show
+        QVariant gNameRaw = romCatalog->value(currentRom->romMD5+"/GoodName",getTranslation("Unknown ROM"));
+        currentRom->goodName = gNameRaw.toStringList().join(", ");
+
+        QStringList CRC = romCatalog->value(currentRom->romMD5+"/CRC","").toString().split(" ");
+
+        if (CRC.size() == 2) {
+            currentRom->CRC1 = CRC[0];
+            currentRom->CRC2 = CRC[1];
+        }
+
+        QString newMD5 = romCatalog->value(currentRom->romMD5+"/RefMD5","").toString();
+        if (newMD5 == "")
+            newMD5 = currentRom->romMD5;
+
+        currentRom->players = romCatalog->value(newMD5+"/Players","").toString();
+        currentRom->saveType = romCatalog->value(newMD5+"/SaveType","").toString();
+        currentRom->rumble = romCatalog->value(newMD5+"/Rumble","").toString();
+    }
+
+    QPair<qint64, int> history = playHistory.value(currentRom->romMD5, qMakePair(qint64(0), 0));
+    currentRom->lastPlayed = history.first;
+    currentRom->playCount = history.second;
+
+    //Sent with the ROM's batch so the collection already has it when the download finishes
+    if (!cached && SETTINGS.value("Other/downloadinfo", "").toString() == "true")
+        neededInfo << qMakePair(currentRom->romMD5, getSearchName(currentRom));
+
+    loadGameInfo(currentRom);
+}
+
+
+bool RomScanner::isExcluded(QString name, QString path)
+{
+    if (excludePatterns.isEmpty())
+        return false;
+
+    //Patterns can match either the name or the path relative to the ROM directory
+    return QDir::match(excludePatterns, name) || QDir::match(excludePatterns, path);
+}
+
+
+bool RomScanner::isCancelled()
+{
+    QMutexLocker locker(&stateMutex);
+    return cancelled;
+}
+
+
+bool RomScanner::keepScanning()
+{
+    //Block here while the user has the scan paused
+    QMutexLocker locker(&stateMutex);
+
+    while (paused && !cancelled)
+        pauseCondition.wait(&stateMutex);
+
+    return !cancelled;
+}
+
+
+void RomScanner::loadCatalog()
+{
+    QString catalogFile = SETTINGS.value("Paths/catalog", "").toString();
+    if (catalogFile == "") {
+        QString dataPath = SETTINGS.value("Paths/data", "").toString();
+        QDir dataDir(dataPath);
+
+        if (QFileInfo(dataDir.absoluteFilePath("mupen64plus.ini")).exists())
+            catalogFile = dataDir.absoluteFilePath("mupen64plus.ini");
+    }
+
+    delete romCatalog;
+    romCatalog = nullptr;
+
+    if (QFileInfo(catalogFile).exists())
+        romCatalog = new QSettings(catalogFile, QSettings::IniFormat);
+}
+
+
+void RomScanner::loadPlayHistory()
+{
+    playHistory.clear();
+
+    QSqlQuery query("SELECT md5, MAX(ended), COUNT(*) FROM play_sessions GROUP BY md5", database);
+
+    while (query.next())
+        playHistory.insert(query.value(0).toString(),
+                           qMakePair(query.value(1).toLongLong(), query.value(2).toInt()));
+
+    query.finish();
+}
+
+
+void RomScanner::loadScanOptions()
+{
+    //Number of subdirectory levels to search, -1 for no limit
+    scanDepth = SETTINGS.value("Paths/scandepth", -1).toInt();
+    followSymlinks = SETTINGS.value("Paths/followsymlinks", "").toString() == "true";
+
+    excludePatterns.clear();
+
+    foreach (QString pattern, SETTINGS.value("Paths/scanexclude", "").toString().split("|"))
+        if (pattern.trimmed() != "")
+            excludePatterns << pattern.trimmed();
+}
+
+
+bool RomScanner::nextFile(int *root, QString *fileName)
+{
+    QMutexLocker locker(&queueMutex);
+
+    while (workQueue.isEmpty() && walksRunning > 0)
+    {
+        queueCondition.wait(&queueMutex, 100);
+
+        if (walkProgress && workQueue.isEmpty())
+            emit progressUpdate(filesFound.load(), 0);
+    }
+
+    if (workQueue.isEmpty())
+        return false;
+
+    QPair<int, QString> next = workQueue.dequeue();
+    *root = next.first;
+    *fileName = next.second;
+
+    return true;
+}
+
+
+void RomScanner::openDatabase()
+{
+    //Connections can only be used from the thread that created them, so the scanner has its own
+    if (!database.isValid()) {
+        database = QSqlDatabase::addDatabase("QSQLITE", "scanner");
+        database.setDatabaseName(getDataLocation() + "/"+AppNameLower+".sqlite");
+    }
+
+    database.open();
+}
+
+
+void RomScanner::prepareInsert(QSqlQuery *query)
+{
+    query->prepare(QString("INSERT INTO rom_collection ")
+                   + "(filename, directory, internal_name, md5, zip_file, size, dd_rom, modified) "
+                   + "VALUES (:filename, :directory, :internal_name, :md5, :zip_file, :size, :dd_rom, "
+                   + ":modified)");
+}
+
+
+void RomScanner::queueRom(Rom currentRom, bool ddRom)
+{
+    if (foundRoms.isEmpty() && foundDDRoms.isEmpty())
+        batchTimer.start();
+
+    if (ddRom)
+        foundDDRoms.append(currentRom);
+    else
+        foundRoms.append(currentRom);
+
+    if (foundRoms.size() + foundDDRoms.size() >= BatchSize || batchTimer.elapsed() >= BatchInterval)
+        flushRoms();
+}
+
+
+void RomScanner::reset()
+{
+    QMutexLocker locker(&stateMutex);
+    cancelled = false;
+    paused = false;
+}
+
+
+void RomScanner::scanDirectory(int root, QString romPath)
+{
+    QDir romDir(romPath);
+    QStringList dirs;
+
+    if (!romDir.exists()) {
+        endWalk(root, dirs);
+        return;
+    }
+
+    //Files and directories come back from a single listing
+    QDir::Filters filters = QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot;
+    if (!followSymlinks)
+        filters |= QDir::NoSymLinks;
+
+    //Directories still to visit, relative to the ROM path, along with their depth
+    QList<QPair<QString, int> > pending;
+    pending << qMakePair(QString(""), 0);
+
+    //Followed links can lead back to a parent, so only visit each real directory once
+    QSet<QString> visited;
+    visited << romDir.canonicalPath();
+
+    dirs << romDir.absolutePath();
+
+    while (!pending.isEmpty() && !isCancelled())
+    {
+        QPair<QString, int> current = pending.takeFirst();
+        QString currentPath = current.first == "" ? romDir.absolutePath() : romDir.absoluteFilePath(current.first);
+        QDirIterator it(currentPath, filters);
+
+        while (it.hasNext())
+        {
+            it.next();
+            QFileInfo info = it.fileInfo();
+            QString fileName = current.first == "" ? info.fileName() : current.first + "/" + info.fileName();
+
+            if (isExcluded(info.fileName(), fileName))
+                continue;
+
+            if (info.isDir()) {
+                if (scanDepth >= 0 && current.second >= scanDepth)
+                    continue;
+
+                QString canonicalPath = info.canonicalFilePath();
+
+                if (visited.contains(canonicalPath))
+                    continue;
+
+                visited << canonicalPath;
+                pending << qMakePair(fileName, current.second + 1);
+                dirs << info.absoluteFilePath();
+            } else if (QDir::match(fileTypes, info.fileName())) {
+                QMutexLocker locker(&queueMutex);
+                workQueue.enqueue(qMakePair(root, fileName));
+                filesFound.fetchAndAddRelaxed(1);
+                queueCondition.wakeOne();
+            }
+        }
+    }
+
+    endWalk(root, dirs);
+}
+
+
+void RomScanner::setPaused(bool paused)
+{
+    QMutexLocker locker(&stateMutex);
+    this->paused = paused;
+    pauseCondition.wakeAll();
+}
+
+
+void RomScanner::startWalks(QStringList romPaths, bool showProgress)
+{
+    loadScanOptions();
+
+    filesFound = 0;
+    walkProgress = showProgress;
+    walkedDirs = QVector<QStringList>(romPaths.size());
+    walksRunning = romPaths.size();
+
+    //Each ROM path is walked on the thread pool so slow drives and network shares don't hold up the rest.
+    //Found files go into the work queue for nextFile()
+    for (int i = 0; i < romPaths.size(); i++)
+        walks << QtConcurrent::run(this, &RomScanner::scanDirectory, i, romPaths.at(i));
+
+    if (showProgress)
+        emit progressUpdate(0, 0);
+}
+
+
+void RomScanner::updateRoms(QStringList romPaths)
+{
+    //Paths that aren't available right now (unmounted shares) are left as they are
+    QStringList availablePaths;
+
+    foreach (QString romPath, romPaths)
+        if (QDir(romPath).exists())
+            availablePaths << romPath;
+
+    openDatabase();
+
+    //Last modified time of each file in the collection, keyed by directory and file
+    QHash<QString, qint64> knownFiles;
+    QSqlQuery query("SELECT directory, filename, zip_file, modified FROM rom_collection", database);
+
+    while (query.next())
+    {
+        QString directory = query.value(0).toString();
+        QString file = query.value(2).toString();
+
+        if (file == "")
+            file = query.value(1).toString();
+
+        if (availablePaths.contains(directory))
+            knownFiles.insert(directory + "/" + file, query.value(3).toLongLong());
+    }
+
+    query.finish();
+
+    QStringList addedFiles, removedFiles;
+    qint64 settledTime = QDateTime::currentMSecsSinceEpoch() - SettleTime;
+    bool settling = false;
+    int root;
+    QString fileName;
+
+    startWalks(availablePaths, false);
+
+    while (nextFile(&root, &fileName))
+    {
+        QString key = availablePaths.at(root) + "/" + fileName;
+        qint64 modified = QFileInfo(QDir(availablePaths.at(root)).absoluteFilePath(fileName))
+                .lastModified().toMSecsSinceEpoch();
+
+        if (modified > settledTime) {
+            settling = true;
+            knownFiles.remove(key);
+            continue;
+        }
+
+        if (!knownFiles.contains(key))
+            addedFiles << key;
+        else if (knownFiles.take(key) != modified) {
+            removedFiles << key;
+            addedFiles << key;
+        }
+    }
+
+    finishWalks();
+
+    //An interrupted walk hasn't seen every file, so it can't tell what was removed
+    if (isCancelled()) {
+        database.close();
+        emit finished(false, true);
+        return;
+    }
+
+    //Anything not seen on disk has been deleted or moved
+    removedFiles += knownFiles.keys();
+
+    if (settling)
+        emit filesSettling();
+
+    if (addedFiles.isEmpty() && removedFiles.isEmpty()) {
+        database.close();
+        emit finished(false, isCancelled());
+        return;
+    }
+
+    database.transaction();
+
+    query.prepare(QString("DELETE FROM rom_collection WHERE directory = :directory AND ")
+                  + "(zip_file = :file OR (zip_file = '' AND filename = :file))");
+
+    foreach (QString key, removedFiles)
+    {
+        //Keys are built from the ROM path, so match them back up to get the directory
+        foreach (QString romPath, availablePaths)
+        {
+            if (key.startsWith(romPath + "/")) {
+                query.bindValue(":directory", romPath);
+                query.bindValue(":file", key.mid(romPath.length() + 1));
+                query.exec();
+                break;
+            }
+        }
+    }
+
+    query.finish();
+
+    //Views only drop ROMs once the delete is durable, modified files are added back after this
+    if (!database.commit()) {
+        database.rollback();
+        database.close();
+        emit finished(false, false);
+        return;
+    }
+
+    emit filesRemoved(removedFiles);
+
+    database.transaction();
+
+    if (!addedFiles.isEmpty()) {
+        prepareInsert(&query);
+
+        loadCatalog();
+        loadPlayHistory();
+        foreach (QString key, addedFiles)
+        {
+            if (!keepScanning())
+                break;
+
+            foreach (QString romPath, availablePaths)
+            {
+                if (key.startsWith(romPath + "/")) {
+                    addFile(romPath, key.mid(romPath.length() + 1), &query);
+                    break;
+                }
+            }
+        }
+
+        flushRoms();
+    }
+
+    bool wasCancelled = isCancelled();
+
+    query.finish();
+
+    if (wasCancelled)
+        database.rollback();
+    else
+        database.commit();
+
+    database.close();
+
+    emit finished(false, wasCancelled);
+}
+
+
+bool RomScanner::walking()
+{
+    QMutexLocker locker(&queueMutex);
+    return walksRunning > 0;
+}
@@ -0,0 +1,138 @@
+/***
+ * Copyright (c) 2013, Dan Hasting
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#ifndef ROMSCANNER_H
+#define ROMSCANNER_H
+
+#include "../common.h"
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QPair>
+#include <QQueue>
+#include <QStringList>
+#include <QVector>
+#include <QWaitCondition>
+#include <QtSql/QSqlDatabase>
+
+class QSettings;
+class QSqlQuery;
+
+
+//Worker object for RomCollection. Lives in its own thread and sends ROMs back as they are loaded
+class RomScanner : public QObject
+{
+    Q_OBJECT
+public:
+    explicit RomScanner(QStringList fileTypes, QObject *parent = 0);
+    ~RomScanner();
+    void cancel();
+    void reset();
+    void setPaused(bool paused);
+
+public slots:
+    void addRoms(QStringList romPaths);
+    void cachedRoms(QStringList romPaths, bool onStartup);
+    void updateRoms(QStringList romPaths);
+
+signals:
+    void ddRomsFound(QVector<Rom> foundRoms);
+    void directoriesFound(QStringList dirs);
+    void filesRemoved(QStringList files);
+    void filesSettling();
+    void finished(bool cached, bool cancelled);
+    void gameInfoNeeded(QString identifier, QString searchName);
+    void fullScanStarted();
+    void progressUpdate(int value, int maximum);
+    void romsFound(QVector<Rom> foundRoms);
+    void scanWarning(QString message);
+
+private:
+    int addFile(QString romPath, QString fileName, QSqlQuery *query);
+    void initializeRom(Rom *currentRom, bool cached);
+    void endWalk(int root, QStringList dirs);
+    void finishWalks();
+    void flushRoms();
+    bool isCancelled();
+    bool isExcluded(QString name, QString path);
+    bool keepScanning();
+    void loadCatalog();
+    void loadPlayHistory();
+    void loadScanOptions();
+    bool nextFile(int *root, QString *fileName);
+    void openDatabase();
+    void prepareInsert(QSqlQuery *query);
+    void queueRom(Rom currentRom, bool ddRom = false);
+
+    Rom addRom(QByteArray *romData, QString fileName, QString directory, QString zipFile, QSqlQuery *query,
+               bool ddRom = false);
+
+    void scanDirectory(int root, QString romPath);
+    void startWalks(QStringList romPaths, bool showProgress);
+    bool walking();
+
+    bool cancelled;
+    bool followSymlinks;
+    bool paused;
+    bool walkProgress;
+    int scanDepth;
+    int walksRunning;
+    QAtomicInt filesFound;
+    QStringList excludePatterns;
+
+    //Files found by the directory walks, waiting to be loaded
+    QMutex queueMutex;
+    QWaitCondition queueCondition;
+    QQueue<QPair<int, QString> > workQueue;
+    QList<QFuture<void> > walks;
+    QVector<QStringList> walkedDirs;
+    QMutex stateMutex;
+    QWaitCondition pauseCondition;
+
+    QElapsedTimer batchTimer;
+    QVector<Rom> foundRoms;
+    QVector<Rom> foundDDRoms;
+    QList<QPair<QString, QString> > neededInfo;
+
+    //Last played time and play count by MD5, from play_sessions
+    QHash<QString, QPair<qint64, int> > playHistory;
+
+    QSettings *romCatalog;
+    QSqlDatabase database;
+    QStringList fileTypes;
+
+};
+
+#endif // ROMSCANNER_H
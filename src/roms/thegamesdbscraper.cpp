@@ -30,70 +30,175 @@
  ***/
 
 #include "thegamesdbscraper.h"
+#include "networkclient.h"
 
 #include "../global.h"
 #include "../common.h"
 
+#include <algorithm>
+
+#include <QBuffer>
 #include <QDir>
 #include <QEventLoop>
+#include <QFutureWatcher>
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
+#include <QImage>
 #include <QMessageBox>
+#include <QtMath>
+#include <QSaveFile>
 #include <QTextStream>
 #include <QTimer>
 #include <QUrl>
 
-#include <QtNetwork/QNetworkAccessManager>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+#include <QRandomGenerator>
+#endif
+#include <QtConcurrent/QtConcurrentRun>
+
 #include <QtNetwork/QNetworkReply>
 #include <QtNetwork/QNetworkRequest>
 
 
+static bool matchSorter(const QPair<double, int> &first, const QPair<double, int> &second)
+{
+    return first.first > second.first;
+}
+
+
 TheGamesDBScraper::TheGamesDBScraper(QWidget *parent, bool force) : QObject(parent)
 {
     this->parent = parent;
     this->force = force;
     this->keepGoing = true;
+
+    allowance = -1;
+    coversInFlight = 0;
+    failedInRow = 0;
+    inFlight = 0;
+
+    tokens = 1;
+    lastRefill = 0;
+    clock.start();
+
+    runCounters = NetworkClient::instance()->getCounters();
+
+    rateTimer = new QTimer(this);
+    rateTimer->setSingleShot(true);
+    retryTimer = new QTimer(this);
+    retryTimer->setSingleShot(true);
+
+    connect(rateTimer, SIGNAL(timeout()), this, SLOT(sendRequests()));
+    connect(retryTimer, SIGNAL(timeout()), this, SLOT(sendRetries()));
 }
 
 
-QString TheGamesDBScraper::convertIDs(QJsonObject foundGame, QString typeName, QString listName)
+void TheGamesDBScraper::coverScaled()
 {
-    QJsonArray idArray = foundGame.value(typeName).toArray();
+    QFutureWatcher<QByteArray> *watcher = static_cast<QFutureWatcher<QByteArray>*>(sender());
+    watcher->deleteLater();
+    coversInFlight--;
+
+    QString identifier = watcher->property("identifier").toString();
+
+    if (keepGoing) {
+        saveCover(identifier, watcher->property("url").toString(), watcher->property("data").toByteArray(),
+                  watcher->result());
+        emit gameInfoReady(identifier);
+    }
+
+    sendRequests();
+    reportErrors();
+}
+
+
+bool TheGamesDBScraper::checkResponse(QJsonObject json)
+{
+    //Every API response says how much of the monthly allowance is left
+    if (json.contains("remaining_monthly_allowance")) {
+        allowance = json.value("remaining_monthly_allowance").toInt() + json.value("extra_allowance").toInt();
+
+        if (allowance <= 0 && parent == nullptr) {
+            int hours = json.value("allowance_refresh_timer").toInt() / 3600;
+            showError(tr("The TheGamesDB request allowance has been used up. It refreshes in %1 hours.")
+                      .arg(hours));
+        }
+    }
+
+    if (json.value("code").toInt() != 200 && json.value("code").toInt() != 0) {
+        QString status = json.value("status").toString();
+        QString message;
+        message = QString(tr("The following error from TheGamesDB occured while downloading:"))
+                           + "<br /><br />" + status + "<br /><br />";
+        showError(message);
+        return false;
+    }
+
+    return true;
+}
 
-    QString cacheFileString = getCacheLocation() + typeName + ".json";
-    QFile cacheFile(cacheFileString);
 
-    cacheFile.open(QIODevice::ReadOnly);
-    QString data = cacheFile.readAll();
-    cacheFile.close();
+QString TheGamesDBScraper::cleanSearchName(QString searchName)
+{
+    //Remove [!], (U), etc. from GoodName for searching
+    searchName.remove(QRegExp("\\W*(\\(|\\[).+(\\)|\\])\\W*"));
+
+    //Few game specific hacks
+    if (searchName == "Legend of Zelda, The - Majora's Mask" ||
+        searchName == "ZELDA MAJORA'S MASK")
+        searchName = "Majora's Mask";
+    else if (searchName == "Legend of Zelda, The - Ocarina of Time" ||
+             searchName == "THE LEGEND OF ZELDA")
+        searchName = "The Legend of Zelda: Ocarina of Time";
+    else if (searchName.toLower().startsWith("tsumi to batsu"))
+        searchName = "Sin and Punishment";
+    else if (searchName.toLower() == "1080 snowboarding")
+        searchName = "1080: TenEighty Snowboarding";
+    else if (searchName == "Extreme-G XG2" || searchName == "Extreme G 2")
+        searchName = "Extreme-G 2";
+    else if (searchName.contains("Pokemon", Qt::CaseInsensitive))
+        searchName.replace("Pokemon", "Pokémon", Qt::CaseInsensitive);
+    else if (searchName.toLower() == "smash brothers")
+        searchName = "Super Smash Bros.";
+    else if (searchName.toLower() == "conker bfd")
+        searchName = "Conker's Bad Fur Day";
+
+    return searchName;
+}
 
-    QJsonDocument document = QJsonDocument::fromJson(data.toUtf8());
-    QJsonObject cache = document.object();
 
-    QString result = "";
+QString TheGamesDBScraper::convertIDs(QJsonObject foundGame, QString typeName, QString listName,
+                                      bool *missing)
+{
+    QJsonArray idArray = foundGame.value(typeName).toArray();
+    QHash<int, QString> list = getList(typeName);
+
+    QStringList result;
 
     foreach (QJsonValue id, idArray)
     {
-        QString entryID = QString::number(id.toInt());
-        QString entryName = cache.value(entryID).toObject().value("name").toString();
+        QString entryName = list.value(id.toInt());
+
+        //Not in the cached list, so it may be new. Only refresh each list once though
+        if (entryName == "" && !refreshedLists.contains(listName)) {
+            //Queued downloads refresh the list in the background and try again
+            if (missing != nullptr) {
+                *missing = true;
+                return "";
+            }
 
-        if (entryName == "") {
-            updateListCache(&cacheFile, listName);
-            cacheFile.open(QIODevice::ReadOnly);
-            data = cacheFile.readAll();
-            cacheFile.close();
+            updateListCache(listName);
 
-            document = QJsonDocument::fromJson(data.toUtf8());
-            entryName = cache.value(entryID).toObject().value("name").toString();
+            list = getList(typeName);
+            entryName = list.value(id.toInt());
         }
 
         if (entryName != "")
-            result += entryName + ", ";
+            result << entryName;
     }
 
-    int pos = result.lastIndexOf(QChar(','));
-    return result.left(pos);
+    return result.join(", ");
 }
 
 
@@ -159,90 +264,47 @@ void TheGamesDBScraper::downloadGameInfo(QString identifier, QString searchName,
             cache.mkpath(gameCache);
         }
 
-        QFile genres(getCacheLocation() + "genres.json");
-        if (!genres.exists())
-            updateListCache(&genres, "Genres");
-
-        QFile developers(getCacheLocation() + "developers.json");
-        if (!developers.exists())
-            updateListCache(&developers, "Developers");
-
-        QFile publishers(getCacheLocation() + "publishers.json");
-        if (!publishers.exists())
-            updateListCache(&publishers, "Publishers");
-
         //Get game JSON info from thegamesdb.net
         QString dataFile = gameCache + "/data.json";
         QFile file(dataFile);
 
         if (!file.exists() || file.size() == 0 || force) {
-            QUrl url;
-
-            //Remove [!], (U), etc. from GoodName for searching
-            searchName.remove(QRegExp("\\W*(\\(|\\[).+(\\)|\\])\\W*"));
-
-            //Few game specific hacks
-            if (searchName == "Legend of Zelda, The - Majora's Mask" ||
-                searchName == "ZELDA MAJORA'S MASK")
-                searchName = "Majora's Mask";
-            else if (searchName == "Legend of Zelda, The - Ocarina of Time" ||
-                     searchName == "THE LEGEND OF ZELDA")
-                searchName = "The Legend of Zelda: Ocarina of Time";
-            else if (searchName.toLower().startsWith("tsumi to batsu"))
-                searchName = "Sin and Punishment";
-            else if (searchName.toLower() == "1080 snowboarding")
-                searchName = "1080: TenEighty Snowboarding";
-            else if (searchName == "Extreme-G XG2" || searchName == "Extreme G 2")
-                searchName = "Extreme-G 2";
-            else if (searchName.contains("Pokemon", Qt::CaseInsensitive))
-                searchName.replace("Pokemon", "Pokémon", Qt::CaseInsensitive);
-            else if (searchName.toLower() == "smash brothers")
-                searchName = "Super Smash Bros.";
-            else if (searchName.toLower() == "conker bfd")
-                searchName = "Conker's Bad Fur Day";
-
-            QString apiFilter = "&filter[platform]=3&include=boxart&fields=game_title,release_date,";
-            apiFilter += "developers,publishers,genres,overview,rating,players";
-
-            QString apiURL = SETTINGS.value("TheGamesDB/url", "https://api.thegamesdb.net/").toString();
-            QString gameIDPrefix = SETTINGS.value("TheGamesDB/ByGameID", "/v1/Games/ByGameID").toString();
-            QString gameNamePrefix = SETTINGS.value("TheGamesDB/ByGameName", "/v1.1/Games/ByGameName").toString();
-
-            //If user submits gameID, use that
-            if (gameID != "")
-                url.setUrl(apiURL + gameIDPrefix + "?apikey=" + TheGamesDBAPIKey + "&id="
-                           + gameID + apiFilter);
-            else
-                url.setUrl(apiURL + gameNamePrefix + "?apikey=" + TheGamesDBAPIKey + "&name="
-                           + searchName + apiFilter);
-
-            QString data = getUrlContents(url);
+            QString cleanName = cleanSearchName(searchName);
+            QString key = getResponseKey(cleanName, gameID);
 
-            QJsonDocument document = QJsonDocument::fromJson(data.toUtf8());
-            QJsonObject json = document.object();
+            //Forced downloads always ask the server, which can still answer from the HTTP cache
+            QByteArray data = getUrlContents(getSearchUrl(cleanName, gameID));
+            QJsonObject json;
 
-            if (json.value("code").toInt() != 200 && json.value("code").toInt() != 0) {
-                QString status = json.value("status").toString();
-                QString message;
-                message = QString(tr("The following error from TheGamesDB occured while downloading:"))
-                                   + "<br /><br />" + status + "<br /><br />";
-                showError(message);
+            if (!parseResponse(data, &json)) {
+                showError(tr("TheGamesDB sent an incomplete response."));
+                if (force) parent->setEnabled(true);
+                return;
+            }
+
+            if (!checkResponse(json)) {
                 if (force) parent->setEnabled(true);
                 return;
             }
 
+            NetworkClient::instance()->saveResponse(key, data);
+
             QJsonValue games = json.value("data").toObject().value("games");
             QJsonArray gamesArray = games.toArray();
 
 
             int count = 0, found = 0;
 
-            foreach (QJsonValue game, gamesArray)
+            //Offer the closest matches first
+            QList<QPair<double, int> > ranking = rankGames(gamesArray, searchName);
+
+            for (int i = 0; i < ranking.size(); i++)
             {
-                QJsonValue title = game.toObject().value("game_title");
+                QJsonObject game = gamesArray.at(ranking.at(i).second).toObject();
+                QJsonValue title = game.value("game_title");
 
                 if (force) { //from user dialog
-                    QJsonValue date = game.toObject().value("release_date");
+                    QJsonValue date = game.value("release_date");
 
                     QString check = "Game: " + title.toString();
                     check.remove(QRegExp(QString("[^A-Za-z 0-9 \\.,\\?'""!@#\\$%\\^&\\*\\")
@@ -254,61 +316,17 @@ void TheGamesDBScraper::downloadGameInfo(QString identifier, QString searchName,
                                                        check, QMessageBox::Yes | QMessageBox::No);
 
                     if (answer == QMessageBox::Yes) {
-                        found = count;
+                        found = ranking.at(i).second;
                         updated = true;
                         break;
                     }
-                } else {
-                    //We only want one game, so search for a perfect match in the GameTitle element.
-                    //Otherwise this will default to 0 (the first game found)
-                    if(title.toString().toLower() == searchName.toLower())
-                        found = count;
                 }
 
                 count++;
             }
 
-            if (!force || updated) {
-                QJsonObject foundGame = gamesArray.at(found).toObject();
-                QJsonObject saveData;
-
-                QString gameID = QString::number(foundGame.value("id").toInt());
-                QJsonObject boxart = json.value("include").toObject().value("boxart").toObject();
-
-                QString thumbURL = boxart.value("base_url").toObject().value("thumb").toString();
-                QJsonArray imgArray = boxart.value("data").toObject().value(gameID).toArray();
-
-                QString frontImg = "";
-
-                foreach (QJsonValue img, imgArray)
-                {
-                    QString type = img.toObject().value("type").toString();
-                    QString side = img.toObject().value("side").toString();
-                    QString filename = img.toObject().value("filename").toString();
-
-                    if (type == "boxart" && side == "front")
-                        frontImg = thumbURL + filename;
-                }
-
-                //Convert IDs from API to text names
-                QString genresString = convertIDs(foundGame, "genres", "Genres");
-                QString developerString = convertIDs(foundGame, "developers", "Developers");
-                QString publisherString = convertIDs(foundGame, "publishers", "Publishers");
-
-                QString players = QString::number(foundGame.value("players").toInt());
-                if (players == "0") players = "";
-
-                saveData.insert("game_title", foundGame.value("game_title").toString());
-                saveData.insert("release_date", foundGame.value("release_date").toString());
-                saveData.insert("rating", foundGame.value("rating").toString());
-                saveData.insert("overview", foundGame.value("overview").toString());
-                saveData.insert("players", players);
-                saveData.insert("boxart", frontImg);
-                saveData.insert("genres", genresString);
-                saveData.insert("developer", developerString);
-                saveData.insert("publisher", publisherString);
-
-                QJsonDocument document(saveData);
+            if (updated) {
+                QJsonDocument document(getGameData(json, found));
 
                 file.open(QIODevice::WriteOnly);
                 file.write(document.toJson());
@@ -329,8 +347,6 @@ void TheGamesDBScraper::downloadGameInfo(QString identifier, QString searchName,
 
 
         //Get front cover
-        QString boxartURL = "";
-        QString boxartExt = "";
         QString coverFile = gameCache + "/boxart-front.";
 
         QFile coverJPG(coverFile + "jpg");
@@ -346,19 +362,8 @@ void TheGamesDBScraper::downloadGameInfo(QString identifier, QString searchName,
             QString boxartURL = json.value("boxart").toString();
 
             if (boxartURL != "") {
-                QUrl url(boxartURL);
-
-                //Delete current box art
-                QFile::remove(coverFile + "jpg");
-                QFile::remove(coverFile + "png");
-
-                //Check to save as JPG or PNG
-                boxartExt = QFileInfo(boxartURL).completeSuffix().toLower();
-                QFile cover(coverFile + boxartExt);
-
-                cover.open(QIODevice::WriteOnly);
-                cover.write(getUrlContents(url));
-                cover.close();
+                QByteArray cover = getUrlContents(QUrl(boxartURL));
+                saveCover(identifier, boxartURL, cover, scaleCover(cover, getCoverSize(), getCoverQuality()));
             }
         }
 
@@ -371,14 +376,306 @@ void TheGamesDBScraper::downloadGameInfo(QString identifier, QString searchName,
 }
 
 
-QByteArray TheGamesDBScraper::getUrlContents(QUrl url)
+int TheGamesDBScraper::findGame(QJsonArray gamesArray, QString searchName)
 {
-    QNetworkAccessManager *manager = new QNetworkAccessManager;
+    //Only take the best result if it's a confident match, a wrong game is worse than none
+    QList<QPair<double, int> > ranking = rankGames(gamesArray, searchName);
+    double threshold = SETTINGS.value("TheGamesDB/matchthreshold", 0.7).toDouble();
+
+    if (ranking.isEmpty() || ranking.first().first < threshold)
+        return -1;
+
+    return ranking.first().second;
+}
+
+
+void TheGamesDBScraper::finishWaiting(QString list)
+{
+    //Marked as refreshed first so the games save with what is cached instead of waiting again
+    if (!refreshedLists.contains(list))
+        refreshedLists << list;
+
+    foreach (QJsonObject waiting, waitingOnList.take(list))
+        saveGameData(waiting.value("identifier").toString(), waiting.value("json").toObject(),
+                     waiting.value("found").toInt());
+}
+
+
+int TheGamesDBScraper::getCoverQuality()
+{
+    return qBound(1, SETTINGS.value("Other/coverquality", 90).toInt(), 100);
+}
+
+
+QSize TheGamesDBScraper::getCoverSize()
+{
+    //Covers are never shown bigger than the largest view's image size, so don't keep them bigger
+    QSize size;
+
+    foreach (QString view, QStringList() << "Table" << "Grid" << "List")
+        size = size.expandedTo(getImageSize(view));
+
+    return size;
+}
+
+
+QJsonObject TheGamesDBScraper::getGameData(QJsonObject json, int found, QString *missingList)
+{
+    QJsonArray gamesArray = json.value("data").toObject().value("games").toArray();
+    QJsonObject foundGame = gamesArray.at(found).toObject();
+    QJsonObject saveData;
+
+    QString gameID = QString::number(foundGame.value("id").toInt());
+    QJsonObject boxart = json.value("include").toObject().value("boxart").toObject();
+
+    QString thumbURL = boxart.value("base_url").toObject().value("thumb").toString();
+    QJsonArray imgArray = boxart.value("data").toObject().value(gameID).toArray();
+
+    QString frontImg = "";
+
+    foreach (QJsonValue img, imgArray)
+    {
+        QString type = img.toObject().value("type").toString();
+        QString side = img.toObject().value("side").toString();
+        QString filename = img.toObject().value("filename").toString();
+
+        if (type == "boxart" && side == "front")
+            frontImg = thumbURL + filename;
+    }
+
+    //Convert IDs from API to text names. Queued downloads are told which list needs refreshing
+    QStringList types, names, results;
+    types << "genres" << "developers" << "publishers";
+    names << "Genres" << "Developers" << "Publishers";
+
+    for (int i = 0; i < types.size(); i++)
+    {
+        bool missing = false;
+        results << convertIDs(foundGame, types.at(i), names.at(i), missingList == nullptr ? nullptr : &missing);
+
+        if (missing) {
+            *missingList = names.at(i);
+            return QJsonObject();
+        }
+    }
+
+    QString genresString = results.at(0);
+    QString developerString = results.at(1);
+    QString publisherString = results.at(2);
+
+    QString players = QString::number(foundGame.value("players").toInt());
+    if (players == "0") players = "";
+
+    //Kept so later refreshes can look the game up by ID instead of searching again
+    if (!foundGame.isEmpty())
+        saveData.insert("id", gameID);
+
+    saveData.insert("game_title", foundGame.value("game_title").toString());
+    saveData.insert("release_date", foundGame.value("release_date").toString());
+    saveData.insert("rating", foundGame.value("rating").toString());
+    saveData.insert("overview", foundGame.value("overview").toString());
+    saveData.insert("players", players);
+    saveData.insert("boxart", frontImg);
+    saveData.insert("genres", genresString);
+    saveData.insert("developer", developerString);
+    saveData.insert("publisher", publisherString);
+
+    return saveData;
+}
 
-    QNetworkRequest request;
-    request.setUrl(url);
-    request.setRawHeader("User-Agent", AppName.toUtf8().constData());
-    QNetworkReply *reply = manager->get(request);
+
+int TheGamesDBScraper::getEditDistance(QString first, QString second)
+{
+    QVector<int> previous(second.size() + 1), current(second.size() + 1);
+
+    for (int j = 0; j <= second.size(); j++)
+        previous[j] = j;
+
+    for (int i = 1; i <= first.size(); i++)
+    {
+        current[0] = i;
+
+        for (int j = 1; j <= second.size(); j++)
+        {
+            int cost = first.at(i - 1) == second.at(j - 1) ? 0 : 1;
+            current[j] = qMin(qMin(previous[j] + 1, current[j - 1] + 1), previous[j - 1] + cost);
+        }
+
+        previous.swap(current);
+    }
+
+    return previous[second.size()];
+}
+
+
+QUrl TheGamesDBScraper::getGameIDUrl(QStringList gameIDs)
+{
+    QString apiFilter = "&filter[platform]=3&include=boxart&fields=game_title,release_date,";
+    apiFilter += "developers,publishers,genres,overview,rating,players";
+
+    QString apiURL = SETTINGS.value("TheGamesDB/url", "https://api.thegamesdb.net/").toString();
+    QString gameIDPrefix = SETTINGS.value("TheGamesDB/ByGameID", "/v1/Games/ByGameID").toString();
+
+    return QUrl(apiURL + gameIDPrefix + "?apikey=" + TheGamesDBAPIKey + "&id=" + gameIDs.join(",")
+                + apiFilter);
+}
+
+
+QHash<int, QString> TheGamesDBScraper::getList(QString typeName)
+{
+    //Parsed once per session, later lookups and refreshes use the hash
+    if (!lists.contains(typeName)) {
+        QFile cacheFile(getCacheLocation() + typeName + ".json");
+
+        cacheFile.open(QIODevice::ReadOnly);
+        QByteArray data = cacheFile.readAll();
+        cacheFile.close();
+
+        lists.insert(typeName, parseList(QJsonDocument::fromJson(data).object()));
+    }
+
+    return lists.value(typeName);
+}
+
+
+double TheGamesDBScraper::getMatchScore(QStringList searchTokens, int searchYear, QJsonObject game)
+{
+    QStringList titleTokens = getTitleTokens(game.value("game_title").toString());
+
+    if (searchTokens.isEmpty() || titleTokens.isEmpty())
+        return 0;
+
+    QString searchTitle = searchTokens.join(" ");
+    QString gameTitle = titleTokens.join(" ");
+
+    if (searchTitle == gameTitle)
+        return 1;
+
+    //Shared words (Dice coefficient), then how close the spelling is overall
+    int shared = 0;
+    foreach (QString token, searchTokens)
+        if (titleTokens.contains(token))
+            shared++;
+
+    double tokenScore = 2.0 * shared / (searchTokens.size() + titleTokens.size());
+    double editScore = 1.0 - double(getEditDistance(searchTitle, gameTitle))
+                             / qMax(searchTitle.size(), gameTitle.size());
+
+    double score = 0.6 * tokenScore + 0.4 * editScore;
+
+    //Different numbers are usually a different game in the series
+    QStringList searchNumbers = searchTokens.filter(QRegExp("^\\d+$"));
+    QStringList titleNumbers = titleTokens.filter(QRegExp("^\\d+$"));
+    if (searchNumbers != titleNumbers)
+        score -= 0.3;
+
+    //Only some names include a year, but it settles remakes and reissues when they do
+    if (searchYear > 0) {
+        int releaseYear = game.value("release_date").toString().left(4).toInt();
+
+        if (releaseYear == searchYear)
+            score += 0.1;
+        else if (releaseYear > 0)
+            score -= 0.1;
+    }
+
+    return qBound(0.0, score, 1.0);
+}
+
+
+QUrl TheGamesDBScraper::getListUrl(QString list)
+{
+    QString apiURL = SETTINGS.value("TheGamesDB/url", "https://api.thegamesdb.net/").toString();
+    QString prefix;
+
+    if (list == "Genres")
+        prefix = SETTINGS.value("TheGamesDB/Genres", "/v1/Genres").toString();
+    else if (list == "Developers")
+        prefix = SETTINGS.value("TheGamesDB/Developers", "/v1/Developers").toString();
+    else if (list == "Publishers")
+        prefix = SETTINGS.value("TheGamesDB/Publishers", "/v1/Publishers").toString();
+
+    return QUrl(apiURL + prefix + "?apikey=" + TheGamesDBAPIKey);
+}
+
+
+QString TheGamesDBScraper::getResponseKey(QString searchName, QString gameID)
+{
+    //Different dumps of the same game clean to the same name, so share one search
+    if (gameID != "")
+        return "id:" + gameID.trimmed();
+
+    return "search:" + searchName.toLower().simplified();
+}
+
+
+QUrl TheGamesDBScraper::getSearchUrl(QString searchName, QString gameID)
+{
+    QUrl url;
+
+    QString apiFilter = "&filter[platform]=3&include=boxart&fields=game_title,release_date,";
+    apiFilter += "developers,publishers,genres,overview,rating,players";
+
+    QString apiURL = SETTINGS.value("TheGamesDB/url", "https://api.thegamesdb.net/").toString();
+    QString gameIDPrefix = SETTINGS.value("TheGamesDB/ByGameID", "/v1/Games/ByGameID").toString();
+    QString gameNamePrefix = SETTINGS.value("TheGamesDB/ByGameName", "/v1.1/Games/ByGameName").toString();
+
+    //If user submits gameID, use that
+    if (gameID != "")
+        url.setUrl(apiURL + gameIDPrefix + "?apikey=" + TheGamesDBAPIKey + "&id="
+                   + gameID + apiFilter);
+    else
+        url.setUrl(apiURL + gameNamePrefix + "?apikey=" + TheGamesDBAPIKey + "&name="
+                   + searchName + apiFilter);
+
+    return url;
+}
+
+
+QStringList TheGamesDBScraper::getTitleTokens(QString title)
+{
+    //Drop accents (Pokémon) and region/dump tags ((U) [!]) before comparing
+    title = title.normalized(QString::NormalizationForm_KD).toLower();
+    title.remove(QRegExp("[^\\x0000-\\x007f]"));
+    title.remove(QRegExp("\\([^)]*\\)|\\[[^\\]]*\\]"));
+
+    title.replace("&", " and ");
+    title.remove(QRegExp("['`]"));
+    title.replace(QRegExp("[^a-z0-9]+"), " ");
+
+    QStringList numerals;
+    numerals << "" << "ii" << "iii" << "iv" << "v" << "vi" << "vii" << "viii" << "ix" << "x";
+
+    QStringList tokens;
+
+    foreach (QString token, title.split(" "))
+    {
+        if (token == "" || token == "the")
+            continue;
+
+        //Sequels are numbered either way (Extreme-G II, Extreme-G 2)
+        if (numerals.indexOf(token) > 0)
+            token = QString::number(numerals.indexOf(token) + 1);
+
+        tokens << token;
+    }
+
+    return tokens;
+}
+
+
+int TheGamesDBScraper::getTimeout()
+{
+    int time = SETTINGS.value("Other/networktimeout", 10).toInt();
+    if (time == 0) time = 10;
+
+    return time * 1000;
+}
+
+
+QByteArray TheGamesDBScraper::getUrlContents(QUrl url)
+{
+    QNetworkReply *reply = NetworkClient::instance()->get(QNetworkRequest(url));
 
     QTimer timer;
     timer.setSingleShot(true);
@@ -387,30 +684,580 @@ QByteArray TheGamesDBScraper::getUrlContents(QUrl url)
     connect(reply, SIGNAL(finished()), &loop, SLOT(quit()));
     connect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
 
-    int time = SETTINGS.value("Other/networktimeout", 10).toInt();
-    if (time == 0) time = 10;
-    time *= 1000;
-
-    timer.start(time);
+    timer.start(getTimeout());
     loop.exec();
 
+    QByteArray data;
+
     if(timer.isActive()) { //Got reply
         timer.stop();
 
         if(reply->error() > 0)
             showError(reply->errorString());
         else
-            return reply->readAll();
+            data = reply->readAll();
 
-    } else //Request timed out
+    } else { //Request timed out
+        reply->abort();
         showError(tr("Request timed out. Check your network settings."));
+    }
+
+    reply->deleteLater();
+
+    return data;
+}
+
+
+bool TheGamesDBScraper::isIdle()
+{
+    return inFlight == 0 && coversInFlight == 0 && requests.isEmpty() && coverRequests.isEmpty() &&
+           retries.isEmpty() && waitingOnList.isEmpty();
+}
+
+
+QHash<int, QString> TheGamesDBScraper::parseList(QJsonObject json)
+{
+    QHash<int, QString> list;
 
-    return QByteArray();
+    foreach (QString key, json.keys())
+        list.insert(key.toInt(), json.value(key).toObject().value("name").toString());
+
+    return list;
+}
+
+
+bool TheGamesDBScraper::parseResponse(QByteArray data, QJsonObject *json)
+{
+    QJsonParseError error;
+    QJsonDocument document = QJsonDocument::fromJson(data, &error);
+
+    if (error.error != QJsonParseError::NoError || !document.isObject())
+        return false;
+
+    *json = document.object();
+
+    //An empty object has no error code either, so it would read as "no games found"
+    return json->contains("data");
+}
+
+
+bool TheGamesDBScraper::queueCover(QString identifier)
+{
+    QString gameCache = getCacheLocation() + identifier.toLower();
+    QString coverFile = gameCache + "/boxart-front.";
+
+    if (QFile(coverFile + "jpg").exists() || QFile(coverFile + "png").exists())
+        return false;
+
+    QFile file(gameCache + "/data.json");
+
+    file.open(QIODevice::ReadOnly);
+    QByteArray data = file.readAll();
+    file.close();
+
+    QString boxartURL = QJsonDocument::fromJson(data).object().value("boxart").toString();
+
+    if (boxartURL == "")
+        return false;
+
+    queueRequest(QUrl(boxartURL), "cover", identifier);
+    return true;
+}
+
+
+void TheGamesDBScraper::queueGameInfo(QString identifier, QString searchName)
+{
+    if (identifier == "")
+        return;
+
+    //Nothing is running, so give it another go after an earlier error
+    if (isIdle()) {
+        keepGoing = true;
+        failedInRow = 0;
+        runCounters = NetworkClient::instance()->getCounters();
+    }
+
+    if (!keepGoing)
+        return;
+
+    QString gameCache = getCacheLocation() + identifier.toLower();
+    QDir cache(gameCache);
+
+    if (!cache.exists())
+        cache.mkpath(gameCache);
+
+    QFile file(gameCache + "/data.json");
+
+    //The full name goes with the request, matching the results uses its tags and year
+    if (!file.exists() || file.size() == 0) {
+        QString cleanName = cleanSearchName(searchName);
+        QByteArray data = NetworkClient::instance()->getResponse(getResponseKey(cleanName, ""));
+
+        //A cached response that doesn't parse is asked for again
+        if (data.isEmpty() || !saveSearchResult(identifier, searchName, data))
+            queueRequest(getSearchUrl(cleanName, ""), "search", identifier, searchName);
+    } else
+        queueCover(identifier);
 }
 
 
-void TheGamesDBScraper::showError(QString error)
+void TheGamesDBScraper::queueRequest(QUrl url, QString type, QString identifier, QString searchName)
 {
+    QNetworkRequest request(url);
+
+    //Kept with the request so the reply knows what it is for
+    request.setAttribute(QNetworkRequest::User, type);
+    request.setAttribute(QNetworkRequest::Attribute(QNetworkRequest::User + 1), identifier);
+    request.setAttribute(QNetworkRequest::Attribute(QNetworkRequest::User + 2), searchName);
+
+    //Covers have their own queue so big downloads don't hold up the searches
+    if (type == "cover")
+        coverRequests.enqueue(request);
+    else
+        requests.enqueue(request);
+
+    sendRequests();
+}
+
+
+QList<QPair<double, int> > TheGamesDBScraper::rankGames(QJsonArray gamesArray, QString searchName)
+{
+    //Year from the full name, e.g. "(1997)", before the tags are stripped
+    int searchYear = 0;
+    QRegExp yearRegex("\\b(19[89]\\d|20\\d\\d)\\b");
+
+    if (yearRegex.indexIn(searchName) != -1)
+        searchYear = yearRegex.cap(1).toInt();
+
+    QStringList searchTokens = getTitleTokens(cleanSearchName(searchName));
+    QList<QPair<double, int> > ranking;
+
+    for (int i = 0; i < gamesArray.size(); i++)
+        ranking << qMakePair(getMatchScore(searchTokens, searchYear, gamesArray.at(i).toObject()), i);
+
+    //Highest score first, ties keep the API's order
+    std::stable_sort(ranking.begin(), ranking.end(), matchSorter);
+
+    return ranking;
+}
+
+
+void TheGamesDBScraper::refreshGameInfo(QStringList identifiers, QStringList searchNames)
+{
+    if (isIdle()) {
+        keepGoing = true;
+        failedInRow = 0;
+        runCounters = NetworkClient::instance()->getCounters();
+    }
+
+    QStringList gameIDs;
+
+    for (int i = 0; i < identifiers.size(); i++)
+    {
+        QString identifier = identifiers.at(i);
+        if (identifier == "")
+            continue;
+
+        QFile file(getCacheLocation() + identifier.toLower() + "/data.json");
+
+        file.open(QIODevice::ReadOnly);
+        QByteArray data = file.readAll();
+        file.close();
+
+        QString gameID = QJsonDocument::fromJson(data).object().value("id").toString();
+
+        //Cached before IDs were stored (or never found), so it still needs a search by name
+        if (gameID == "") {
+            QString searchName = searchNames.value(i);
+            queueRequest(getSearchUrl(cleanSearchName(searchName), ""), "search", identifier, searchName);
+            continue;
+        }
+
+        if (!gameIDLookups.contains(gameID))
+            gameIDs << gameID;
+
+        gameIDLookups[gameID] << identifier;
+    }
+
+    //ByGameID takes a comma separated list, so refresh many games with each request
+    int batchSize = SETTINGS.value("TheGamesDB/idbatch", 20).toInt();
+    if (batchSize < 1) batchSize = 1;
+
+    for (int i = 0; i < gameIDs.size(); i += batchSize)
+    {
+        QStringList batch = gameIDs.mid(i, batchSize);
+        queueRequest(getGameIDUrl(batch), "ids", batch.join(","));
+    }
+}
+
+
+void TheGamesDBScraper::replyFinished()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+    reply->deleteLater();
+
+    QString type = reply->request().attribute(QNetworkRequest::User).toString();
+    QString identifier = reply->request().attribute(QNetworkRequest::Attribute(QNetworkRequest::User + 1))
+                                                    .toString();
+    QString searchName = reply->request().attribute(QNetworkRequest::Attribute(QNetworkRequest::User + 2))
+                                                    .toString();
+
+    //Covers stay counted until they are scaled and saved
+    if (type != "cover")
+        inFlight--;
+    else if (reply->error() != QNetworkReply::NoError || !keepGoing)
+        coversInFlight--;
+
+    if (reply->error() != QNetworkReply::NoError) {
+        if (keepGoing && !retryRequest(reply)) {
+            QString error = reply->errorString();
+            if (reply->error() == QNetworkReply::OperationCanceledError)
+                error = tr("Request timed out. Check your network settings.");
+
+            //A list that can't be refreshed still leaves its games with the cached names
+            if (type == "list")
+                finishWaiting(identifier);
+
+            //Keep going past the odd failure, but stop if nothing is getting through
+            failedInRow++;
+            showError((searchName != "" ? searchName : identifier) + ": " + error, failedInRow >= 5);
+        }
+    } else if (keepGoing) {
+        QByteArray data = reply->readAll();
+        bool received = true;
+
+        if (type == "search") {
+            received = saveSearchResult(identifier, searchName, data);
+        } else if (type == "ids") {
+            received = saveGameIDResults(identifier.split(","), data);
+        } else if (type == "cover") {
+            //Decoding and scaling is slow for large images, so keep it off the GUI thread
+            QFutureWatcher<QByteArray> *watcher = new QFutureWatcher<QByteArray>(this);
+            watcher->setProperty("identifier", identifier);
+            watcher->setProperty("url", reply->request().url().toString());
+            watcher->setProperty("data", data);
+
+            connect(watcher, SIGNAL(finished()), this, SLOT(coverScaled()));
+            watcher->setFuture(QtConcurrent::run(scaleCover, data, getCoverSize(), getCoverQuality()));
+        } else if (type == "list") {
+            saveListCache(identifier, data);
+            finishWaiting(identifier);
+        }
+
+        //An empty or cut off body with a 200 counts against the run like any other failed request
+        if (received)
+            failedInRow = 0;
+        else {
+            failedInRow++;
+            showError((searchName != "" ? searchName : identifier) + ": "
+                      + tr("TheGamesDB sent an incomplete response."), failedInRow >= 5);
+        }
+    }
+
+    //Stopped after an error, so drop anything left over
+    if (!keepGoing) {
+        coverRequests.clear();
+        requests.clear();
+        retries.clear();
+        gameIDLookups.clear();
+        waitingOnList.clear();
+    }
+
+    sendRequests();
+    reportErrors();
+}
+
+
+void TheGamesDBScraper::reportErrors()
+{
+    //Background downloads report everything that went wrong once the queue is done
+    if (!isIdle())
+        return;
+
+    if (!errors.isEmpty()) {
+        QString summary = tr("Some game information could not be downloaded:") + "<br /><br />";
+        summary += QStringList(errors.mid(0, 10)).join("<br />");
+
+        if (errors.size() > 10)
+            summary += "<br />" + tr("...and %1 more.").arg(errors.size() - 10);
+
+        if (allowance >= 0)
+            summary += "<br /><br />" + tr("Remaining TheGamesDB allowance: %1").arg(allowance);
+
+        errors.clear();
+        emit scrapeError(summary);
+    }
+
+    //Requests, handshakes and cache hits for the run that just ended
+    NetworkCounters counters = NetworkClient::instance()->getCounters();
+    QString status = NetworkClient::getSummary(runCounters, counters);
+    runCounters = counters;
+
+    if (status != "")
+        emit statusUpdate(status, 10000);
+
+    emit queueFinished();
+}
+
+
+bool TheGamesDBScraper::retryRequest(QNetworkReply *reply)
+{
+    QList<QNetworkReply::NetworkError> transientErrors;
+    transientErrors << QNetworkReply::OperationCanceledError
+                    << QNetworkReply::RemoteHostClosedError
+                    << QNetworkReply::TimeoutError
+                    << QNetworkReply::TemporaryNetworkFailureError
+                    << QNetworkReply::NetworkSessionFailedError
+                    << QNetworkReply::ProxyTimeoutError;
+
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status != 429 && status < 500 && !transientErrors.contains(reply->error()))
+        return false;
+
+    QNetworkRequest request = reply->request();
+    int attempt = request.attribute(QNetworkRequest::Attribute(QNetworkRequest::User + 3)).toInt();
+
+    if (attempt >= SETTINGS.value("Other/scraperretries", 3).toInt())
+        return false;
+
+    //Double the wait each attempt, with jitter so requests that failed together don't retry together
+    int delay = 1000 << attempt;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+    delay = delay / 2 + QRandomGenerator::global()->bounded(delay);
+#else
+    delay = delay / 2 + qrand() % delay;
+#endif
+
+    //Rate limited or down for maintenance, the server may say how long to wait
+    delay = qMax(delay, reply->rawHeader("Retry-After").toInt() * 1000);
+
+    request.setAttribute(QNetworkRequest::Attribute(QNetworkRequest::User + 3), attempt + 1);
+    retries.insert(clock.elapsed() + delay, request);
+    retryTimer->start(qMax(qint64(0), retries.firstKey() - clock.elapsed()));
+
+    return true;
+}
+
+
+void TheGamesDBScraper::saveCover(QString identifier, QString boxartURL, QByteArray data, QByteArray scaled)
+{
+    QString coverFile = getCacheLocation() + identifier.toLower() + "/boxart-front.";
+
+    //Delete current box art
+    QFile::remove(coverFile + "jpg");
+    QFile::remove(coverFile + "png");
+
+    //Scaled covers are re-encoded as JPG. Keep the download as is if it couldn't be decoded
+    QString boxartExt = "jpg";
+
+    if (scaled.isEmpty())
+        boxartExt = QFileInfo(boxartURL).completeSuffix().toLower();
+    else
+        data = scaled;
+
+    QFile cover(coverFile + boxartExt);
+
+    cover.open(QIODevice::WriteOnly);
+    cover.write(data);
+    cover.close();
+}
+
+
+void TheGamesDBScraper::saveGameData(QString identifier, QJsonObject json, int found)
+{
+    QString missingList = "";
+    QJsonObject saveData = getGameData(json, found, &missingList);
+
+    //An ID isn't in the cached list yet. Park the game until the list is refreshed
+    if (missingList != "") {
+        QJsonObject waiting;
+        waiting.insert("identifier", identifier);
+        waiting.insert("json", json);
+        waiting.insert("found", found);
+
+        if (!waitingOnList.contains(missingList))
+            queueRequest(getListUrl(missingList), "list", missingList);
+
+        waitingOnList[missingList] << waiting;
+        return;
+    }
+
+    QFile file(getCacheLocation() + identifier.toLower() + "/data.json");
+
+    file.open(QIODevice::WriteOnly);
+    file.write(QJsonDocument(saveData).toJson());
+    file.close();
+
+    if (!queueCover(identifier))
+        emit gameInfoReady(identifier);
+}
+
+
+bool TheGamesDBScraper::saveGameIDResults(QStringList gameIDs, QByteArray data)
+{
+    QJsonObject json;
+    bool valid = parseResponse(data, &json);
+
+    if (valid && checkResponse(json)) {
+        QJsonArray gamesArray = json.value("data").toObject().value("games").toArray();
+
+        for (int i = 0; i < gamesArray.size(); i++)
+        {
+            QString gameID = QString::number(gamesArray.at(i).toObject().value("id").toInt());
+
+            foreach (QString identifier, gameIDLookups.take(gameID))
+                saveGameData(identifier, json, i);
+        }
+    }
+
+    //Anything the API didn't return keeps its current information
+    foreach (QString gameID, gameIDs)
+        gameIDLookups.remove(gameID);
+
+    return valid;
+}
+
+
+void TheGamesDBScraper::saveListCache(QString list, QByteArray data)
+{
+    QJsonDocument document = QJsonDocument::fromJson(data);
+    QJsonObject result = document.object().value("data").toObject().value(list.toLower()).toObject();
+
+    refreshedLists << list;
+
+    //Failed download, keep what is already cached
+    if (result.isEmpty())
+        return;
+
+    //Written to a temporary file and renamed so an interrupted write can't corrupt the cache
+    QSaveFile file(getCacheLocation() + list.toLower() + ".json");
+
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(result).toJson());
+        file.commit();
+    }
+
+    lists.insert(list.toLower(), parseList(result));
+}
+
+
+bool TheGamesDBScraper::saveSearchResult(QString identifier, QString searchName, QByteArray data)
+{
+    QJsonObject json;
+
+    //Nothing is cached or written from a broken response, so the game is asked for again later
+    if (!parseResponse(data, &json))
+        return false;
+
+    if (checkResponse(json)) {
+        NetworkClient::instance()->saveResponse(getResponseKey(cleanSearchName(searchName), ""), data);
+
+        QJsonArray gamesArray = json.value("data").toObject().value("games").toArray();
+        saveGameData(identifier, json, findGame(gamesArray, searchName));
+    }
+
+    return true;
+}
+
+
+QByteArray TheGamesDBScraper::scaleCover(QByteArray data, QSize size, int quality)
+{
+    QImage image;
+
+    if (!image.loadFromData(data))
+        return QByteArray();
+
+    //Only shrink, and cover the whole view size since the grid view can stretch images
+    if (image.width() > size.width() && image.height() > size.height())
+        image = image.scaled(size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+
+    QByteArray scaled;
+    QBuffer buffer(&scaled);
+
+    buffer.open(QIODevice::WriteOnly);
+    if (!image.convertToFormat(QImage::Format_RGB32).save(&buffer, "JPG", quality))
+        return QByteArray();
+
+    //Already small and compressed, re-encoding would only make it bigger
+    if (scaled.size() >= data.size())
+        return QByteArray();
+
+    return scaled;
+}
+
+
+void TheGamesDBScraper::sendRequest(QNetworkRequest request)
+{
+    QNetworkReply *reply = NetworkClient::instance()->get(request);
+
+    connect(reply, SIGNAL(finished()), this, SLOT(replyFinished()));
+
+    //Aborting finishes the reply with OperationCanceledError
+    QTimer *timer = new QTimer(reply);
+    timer->setSingleShot(true);
+    connect(timer, SIGNAL(timeout()), reply, SLOT(abort()));
+    timer->start(getTimeout());
+}
+
+
+void TheGamesDBScraper::sendRequests()
+{
+    int maxRequests = SETTINGS.value("Other/scraperrequests", 4).toInt();
+    if (maxRequests < 1) maxRequests = 1;
+
+    int maxCovers = SETTINGS.value("Other/coverrequests", 4).toInt();
+    if (maxCovers < 1) maxCovers = 1;
+
+    while (keepGoing && inFlight < maxRequests && !requests.isEmpty() && takeToken())
+    {
+        sendRequest(requests.dequeue());
+        inFlight++;
+    }
+
+    while (keepGoing && coversInFlight < maxCovers && !coverRequests.isEmpty() && takeToken())
+    {
+        sendRequest(coverRequests.dequeue());
+        coversInFlight++;
+    }
+}
+
+
+void TheGamesDBScraper::sendRetries()
+{
+    qint64 now = clock.elapsed();
+
+    //Retries go to the front so they finish before newer work
+    while (!retries.isEmpty() && retries.firstKey() <= now)
+    {
+        QNetworkRequest request = retries.take(retries.firstKey());
+
+        if (request.attribute(QNetworkRequest::User).toString() == "cover")
+            coverRequests.prepend(request);
+        else
+            requests.prepend(request);
+    }
+
+    if (!retries.isEmpty())
+        retryTimer->start(retries.firstKey() - now);
+
+    sendRequests();
+}
+
+
+void TheGamesDBScraper::showError(QString error, bool fatal)
+{
+    //Without a parent there is nobody to ask (background scan), so collect it for the summary
+    if (parent == nullptr) {
+        //Other requests in flight fail the same way, only keep the first
+        if (keepGoing && !errors.contains(error))
+            errors << error;
+
+        if (fatal)
+            keepGoing = false;
+
+        return;
+    }
+
     QString question = "\n\n" + tr("Continue scraping information?");
 
     if (force)
@@ -425,28 +1272,33 @@ void TheGamesDBScraper::showError(QString error)
 }
 
 
-void TheGamesDBScraper::updateListCache(QFile *file, QString list)
+bool TheGamesDBScraper::takeToken()
 {
-    if (keepGoing) {
-        QUrl url;
-
-        QString apiURL = SETTINGS.value("TheGamesDB/url", "https://api.thegamesdb.net/").toString();
-        QString prefix;
-
-        if (list == "Genres")
-            prefix = SETTINGS.value("TheGamesDB/Genres", "/v1/Genres").toString();
-        else if (list == "Developers")
-            prefix = SETTINGS.value("TheGamesDB/Developers", "/v1/Developers").toString();
-        else if (list == "Publishers")
-            prefix = SETTINGS.value("TheGamesDB/Publishers", "/v1/Publishers").toString();
-
-        url.setUrl(apiURL + prefix + "?apikey=" + TheGamesDBAPIKey);
-        QString data = getUrlContents(url);
-        QJsonDocument document = QJsonDocument::fromJson(data.toUtf8());
-        QJsonDocument result(document.object().value("data").toObject().value(list.toLower()).toObject());
-
-        file->open(QIODevice::WriteOnly);
-        file->write(result.toJson());
-        file->close();
+    //Token bucket: refills at Other/scraperrate requests a second, bursts up to the request limit
+    double rate = SETTINGS.value("Other/scraperrate", 2).toDouble();
+    if (rate <= 0)
+        return true;
+
+    double capacity = qMax(1, SETTINGS.value("Other/scraperrequests", 4).toInt());
+    qint64 now = clock.elapsed();
+
+    tokens = qMin(capacity, tokens + (now - lastRefill) * rate / 1000);
+    lastRefill = now;
+
+    if (tokens >= 1) {
+        tokens -= 1;
+        return true;
     }
+
+    if (!rateTimer->isActive())
+        rateTimer->start(qCeil((1 - tokens) * 1000 / rate));
+
+    return false;
+}
+
+
+void TheGamesDBScraper::updateListCache(QString list)
+{
+    if (keepGoing)
+        saveListCache(list, getUrlContents(getListUrl(list)));
 }
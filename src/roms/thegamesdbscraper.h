@@ -32,9 +32,22 @@
 #ifndef THEGAMESDBSCRAPER_H
 #define THEGAMESDBSCRAPER_H
 
-#include <QFile>
+#include "networkclient.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QMap>
+#include <QPair>
+#include <QQueue>
+#include <QSize>
 #include <QWidget>
 
+#include <QtNetwork/QNetworkRequest>
+
+class QNetworkReply;
+class QTimer;
 class QUrl;
 
 
@@ -46,15 +59,91 @@ public:
     void deleteGameInfo(QString fileName, QString identifier);
     void downloadGameInfo(QString identifier, QString searchName, QString gameID = "");
 
+public slots:
+    void queueGameInfo(QString identifier, QString searchName);
+    void refreshGameInfo(QStringList identifiers, QStringList searchNames);
+
+signals:
+    void gameInfoReady(QString identifier);
+    void queueFinished();
+    void scrapeError(QString error);
+    void statusUpdate(QString message, int timeout);
+
 private:
-    QString convertIDs(QJsonObject foundGame, QString typeName, QString listName);
+    bool checkResponse(QJsonObject json);
+    QString cleanSearchName(QString searchName);
+    QString convertIDs(QJsonObject foundGame, QString typeName, QString listName, bool *missing = nullptr);
+    int findGame(QJsonArray gamesArray, QString searchName);
+    void finishWaiting(QString list);
+    int getCoverQuality();
+    QSize getCoverSize();
+    int getEditDistance(QString first, QString second);
+    QJsonObject getGameData(QJsonObject json, int found, QString *missingList = nullptr);
+    QUrl getGameIDUrl(QStringList gameIDs);
+    QHash<int, QString> getList(QString typeName);
+    QUrl getListUrl(QString list);
+    double getMatchScore(QStringList searchTokens, int searchYear, QJsonObject game);
+    QString getResponseKey(QString searchName, QString gameID);
+    QUrl getSearchUrl(QString searchName, QString gameID);
+    int getTimeout();
+    QStringList getTitleTokens(QString title);
     QByteArray getUrlContents(QUrl url);
-    void showError(QString error);
-    void updateListCache(QFile *file, QString list);
+    bool isIdle();
+    QHash<int, QString> parseList(QJsonObject json);
+    bool parseResponse(QByteArray data, QJsonObject *json);
+    bool queueCover(QString identifier);
+    void queueRequest(QUrl url, QString type, QString identifier, QString searchName = "");
+    QList<QPair<double, int> > rankGames(QJsonArray gamesArray, QString searchName);
+    void reportErrors();
+    bool retryRequest(QNetworkReply *reply);
+    void saveCover(QString identifier, QString boxartURL, QByteArray data, QByteArray scaled);
+    void saveGameData(QString identifier, QJsonObject json, int found);
+    bool saveGameIDResults(QStringList gameIDs, QByteArray data);
+    void saveListCache(QString list, QByteArray data);
+    bool saveSearchResult(QString identifier, QString searchName, QByteArray data);
+    static QByteArray scaleCover(QByteArray data, QSize size, int quality);
+    void sendRequest(QNetworkRequest request);
+    void showError(QString error, bool fatal = true);
+    bool takeToken();
+    void updateListCache(QString list);
 
     bool force;
     bool keepGoing;
+    int allowance;
+    int coversInFlight;
+    int failedInRow;
+    int inFlight;
     QWidget *parent;
+
+    //Genre, developer and publisher names by ID, and the lists refreshed this session
+    QHash<QString, QHash<int, QString> > lists;
+    QStringList refreshedLists;
+
+    //Downloads for the background queue, limited to a few requests at a time
+    QQueue<QNetworkRequest> coverRequests;
+    QQueue<QNetworkRequest> requests;
+    QHash<QString, QStringList> gameIDLookups;
+    QHash<QString, QList<QJsonObject> > waitingOnList;
+
+    //Pacing for the queue: a token bucket, and failed requests waiting to be retried
+    double tokens;
+    qint64 lastRefill;
+    QElapsedTimer clock;
+    QMultiMap<qint64, QNetworkRequest> retries;
+    QTimer *rateTimer;
+    QTimer *retryTimer;
+
+    //Problems from background downloads, reported together when the queue is done
+    QStringList errors;
+
+    //Network totals when the queue last started, the difference is reported when it's done
+    NetworkCounters runCounters;
+
+private slots:
+    void coverScaled();
+    void replyFinished();
+    void sendRequests();
+    void sendRetries();
 };
 
 #endif // THEGAMESDBSCRAPER_H
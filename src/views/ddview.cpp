@@ -68,19 +68,28 @@ void DDView::addNoDiskRow()
 }
 
 
-void DDView::addTo64DDView(Rom *currentRom)
+void DDView::addTo64DDView(Rom *roms, int count)
 {
-    fileItem = new TreeWidgetItem(this);
+    QList<QTreeWidgetItem*> items;
 
-    fileItem->setText(0, currentRom->fileName); //Filename for launching ROM
-    fileItem->setText(1, currentRom->directory); //Directory ROM is located in
-    fileItem->setText(2, ""); //GoodName or Internal Name for searching (currently blank)
-    fileItem->setText(3, currentRom->romMD5.toLower()); //MD5 for cache info
-    fileItem->setText(4, currentRom->zipFile); //Zip file
+    for (int i = 0; i < count; i++)
+    {
+        Rom *currentRom = &roms[i];
 
-    fileItem->setText(5, QFileInfo(currentRom->fileName).completeBaseName()); //Visible filename
+        fileItem = new TreeWidgetItem();
 
-    addTopLevelItem(fileItem);
+        fileItem->setText(0, currentRom->fileName); //Filename for launching ROM
+        fileItem->setText(1, currentRom->directory); //Directory ROM is located in
+        fileItem->setText(2, ""); //GoodName or Internal Name for searching (currently blank)
+        fileItem->setText(3, currentRom->romMD5.toLower()); //MD5 for cache info
+        fileItem->setText(4, currentRom->zipFile); //Zip file
+
+        fileItem->setText(5, QFileInfo(currentRom->fileName).completeBaseName()); //Visible filename
+
+        items << fileItem;
+    }
+
+    addTopLevelItems(items);
 }
 
 
@@ -53,7 +53,7 @@ private:
     TreeWidgetItem *fileItem;
 
 private slots:
-    void addTo64DDView(Rom *currentRom);
+    void addTo64DDView(Rom *roms, int count);
 
 };
 
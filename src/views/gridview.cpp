@@ -74,109 +74,121 @@ GridView::GridView(QWidget *parent) : QScrollArea(parent)
 }
 
 
-void GridView::addToGridView(Rom *currentRom, int count, bool ddEnabled)
+void GridView::addToGridView(Rom *roms, int first, int count, bool ddEnabled)
 {
-    if (ddEnabled) // Add place for "No Cart" entry
-        count++;
+    //Settings are the same for the whole batch, so only look them up once
+    QSize imageSize = getImageSize("Grid");
+    int itemWidth = getGridSize("width");
+    bool showLabel = SETTINGS.value("Grid/label","true") == "true";
+    QString labelText = SETTINGS.value("Grid/labeltext","Filename").toString();
+    QString textHex = getColor(SETTINGS.value("Grid/labelcolor","White").toString()).name();
+    QString labelStyle = "QLabel { font-weight: bold; color: " + textHex + "; font-size: "
+                         + QString::number(getGridSize("font")) + "px; }";
 
-    ClickableWidget *gameGridItem = new ClickableWidget(gridWidget);
-    gameGridItem->setMinimumWidth(getGridSize("width"));
-    gameGridItem->setMaximumWidth(getGridSize("width"));
-    gameGridItem->setGraphicsEffect(getShadow(false));
-    gameGridItem->setContextMenuPolicy(Qt::CustomContextMenu);
-
-    //Assign ROM data to widget for use in click events
-    gameGridItem->setProperty("fileName", currentRom->fileName);
-    gameGridItem->setProperty("directory", currentRom->directory);
-    if (currentRom->goodName == getTranslation("Unknown ROM") ||
-        currentRom->goodName == getTranslation("Requires catalog file"))
-        gameGridItem->setProperty("search", currentRom->internalName);
+    int columnCount;
+    if (SETTINGS.value("Grid/autocolumns","true").toString() == "true")
+        columnCount = viewport()->width() / (itemWidth + 10);
     else
-        gameGridItem->setProperty("search", currentRom->goodName);
-    gameGridItem->setProperty("romMD5", currentRom->romMD5);
-    gameGridItem->setProperty("zipFile", currentRom->zipFile);
-
-    QGridLayout *gameGridLayout = new QGridLayout(gameGridItem);
-    gameGridLayout->setColumnStretch(0, 1);
-    gameGridLayout->setColumnStretch(3, 1);
-    gameGridLayout->setRowMinimumHeight(1, getImageSize("Grid").height());
-
-    QLabel *gridImageLabel = new QLabel(gameGridItem);
-    gridImageLabel->setMinimumHeight(getImageSize("Grid").height());
-    gridImageLabel->setMinimumWidth(getImageSize("Grid").width());
-    QPixmap image;
-
-    if (currentRom->imageExists) {
-        //Use uniform aspect ratio to account for fluctuations in TheGamesDB box art
-        Qt::AspectRatioMode aspectRatioMode = Qt::IgnoreAspectRatio;
-
-        //Don't warp aspect ratio though if image is too far away from standard size (JP box art)
-        double aspectRatio = double(currentRom->image.width()) / currentRom->image.height();
-
-        if (aspectRatio < 1.1 || aspectRatio > 1.8)
-            aspectRatioMode = Qt::KeepAspectRatio;
-
-        image = currentRom->image.scaled(getImageSize("Grid"), aspectRatioMode, Qt::SmoothTransformation);
-    } else {
-        if (ddEnabled && count == 0)
-            image = QPixmap(":/images/no-cart.png").scaled(getImageSize("Grid"), Qt::IgnoreAspectRatio,
-                                                             Qt::SmoothTransformation);
-        else
-            image = QPixmap(":/images/not-found.png").scaled(getImageSize("Grid"), Qt::IgnoreAspectRatio,
-                                                             Qt::SmoothTransformation);
-    }
+        columnCount = SETTINGS.value("Grid/columncount", "4").toInt();
 
-    gridImageLabel->setPixmap(image);
-    gridImageLabel->setAlignment(Qt::AlignCenter);
-    gameGridLayout->addWidget(gridImageLabel, 1, 1);
+    if (columnCount == 0) columnCount = 1;
 
-    if (SETTINGS.value("Grid/label","true") == "true") {
-        QLabel *gridTextLabel = new QLabel(gameGridItem);
+    QPixmap noCartImage, notFoundImage;
 
-        //Don't allow label to be wider than image
-        gridTextLabel->setMaximumWidth(getImageSize("Grid").width());
+    //Hold off on painting and layout until the whole batch is in
+    gridWidget->setUpdatesEnabled(false);
 
-        QString text = "";
-        QString labelText = SETTINGS.value("Grid/labeltext","Filename").toString();
+    for (int i = 0; i < count; i++)
+    {
+        Rom *currentRom = &roms[i];
+        int position = first + i;
+
+        if (ddEnabled) // Add place for "No Cart" entry
+            position++;
+
+        bool noCart = ddEnabled && position == 0;
+
+        ClickableWidget *gameGridItem = new ClickableWidget(gridWidget);
+        gameGridItem->setMinimumWidth(itemWidth);
+        gameGridItem->setMaximumWidth(itemWidth);
+        gameGridItem->setGraphicsEffect(getShadow(false));
+        gameGridItem->setContextMenuPolicy(Qt::CustomContextMenu);
+
+        //Assign ROM data to widget for use in click events
+        gameGridItem->setProperty("fileName", currentRom->fileName);
+        gameGridItem->setProperty("directory", currentRom->directory);
+        if (currentRom->goodName == getTranslation("Unknown ROM") ||
+            currentRom->goodName == getTranslation("Requires catalog file"))
+            gameGridItem->setProperty("search", currentRom->internalName);
+        else
+            gameGridItem->setProperty("search", currentRom->goodName);
+        gameGridItem->setProperty("romMD5", currentRom->romMD5);
+        gameGridItem->setProperty("zipFile", currentRom->zipFile);
+
+        QGridLayout *gameGridLayout = new QGridLayout(gameGridItem);
+        gameGridLayout->setColumnStretch(0, 1);
+        gameGridLayout->setColumnStretch(3, 1);
+        gameGridLayout->setRowMinimumHeight(1, imageSize.height());
+
+        QLabel *gridImageLabel = new QLabel(gameGridItem);
+        gridImageLabel->setObjectName("gridImageLabel");
+        gridImageLabel->setMinimumHeight(imageSize.height());
+        gridImageLabel->setMinimumWidth(imageSize.width());
+        QPixmap image;
+
+        if (currentRom->imageExists)
+            image = getRomImage(currentRom, imageSize);
+        else if (noCart) {
+            if (noCartImage.isNull())
+                noCartImage = QPixmap(":/images/no-cart.png").scaled(imageSize, Qt::IgnoreAspectRatio,
+                                                                      Qt::SmoothTransformation);
+            image = noCartImage;
+        } else {
+            if (notFoundImage.isNull())
+                notFoundImage = QPixmap(":/images/not-found.png").scaled(imageSize, Qt::IgnoreAspectRatio,
+                                                                         Qt::SmoothTransformation);
+            image = notFoundImage;
+        }
 
-        text = getRomInfo(labelText, currentRom);
+        gridImageLabel->setPixmap(image);
+        gridImageLabel->setAlignment(Qt::AlignCenter);
+        gameGridLayout->addWidget(gridImageLabel, 1, 1);
 
-        if (ddEnabled && count == 0)
-            text = tr("No Cart");
+        if (showLabel) {
+            QLabel *gridTextLabel = new QLabel(gameGridItem);
+            gridTextLabel->setObjectName("gridTextLabel");
 
-        gridTextLabel->setText(text);
+            //Don't allow label to be wider than image
+            gridTextLabel->setMaximumWidth(imageSize.width());
 
-        QString textHex = getColor(SETTINGS.value("Grid/labelcolor","White").toString()).name();
-        int fontSize = getGridSize("font");
+            QString text = getRomInfo(labelText, currentRom);
 
-        gridTextLabel->setStyleSheet("QLabel { font-weight: bold; color: " + textHex + "; font-size: "
-                                     + QString::number(fontSize) + "px; }");
-        gridTextLabel->setWordWrap(true);
-        gridTextLabel->setAlignment(Qt::AlignHCenter | Qt::AlignTop);
+            if (noCart)
+                text = tr("No Cart");
 
-        gameGridLayout->addWidget(gridTextLabel, 2, 1);
-    }
+            gridTextLabel->setText(text);
+            gridTextLabel->setStyleSheet(labelStyle);
+            gridTextLabel->setWordWrap(true);
+            gridTextLabel->setAlignment(Qt::AlignHCenter | Qt::AlignTop);
 
-    gameGridItem->setLayout(gameGridLayout);
+            gameGridLayout->addWidget(gridTextLabel, 2, 1);
+        }
 
-    gameGridItem->setMinimumHeight(gameGridItem->sizeHint().height());
+        gameGridItem->setLayout(gameGridLayout);
 
-    int columnCount;
-    if (SETTINGS.value("Grid/autocolumns","true").toString() == "true")
-        columnCount = viewport()->width() / (getGridSize("width") + 10);
-    else
-        columnCount = SETTINGS.value("Grid/columncount", "4").toInt();
+        gameGridItem->setMinimumHeight(gameGridItem->sizeHint().height());
 
-    if (columnCount == 0) columnCount = 1;
+        gridLayout->addWidget(gameGridItem, position / columnCount + 1, position % columnCount + 1);
 
-    gridLayout->addWidget(gameGridItem, count / columnCount + 1, count % columnCount + 1);
-    gridWidget->adjustSize();
+        connect(gameGridItem, SIGNAL(singleClicked(QWidget*)), this, SLOT(highlightGridWidget(QWidget*)));
+        connect(gameGridItem, SIGNAL(doubleClicked(QWidget*)), parent, SLOT(launchRomFromWidget(QWidget*)));
+        connect(gameGridItem, SIGNAL(arrowPressed(QWidget*, QString)), this, SLOT(selectNextRom(QWidget*, QString)));
+        connect(gameGridItem, SIGNAL(enterPressed(QWidget*)), parent, SLOT(launchRomFromWidget(QWidget*)));
+        connect(gameGridItem, SIGNAL(customContextMenuRequested(const QPoint &)), parent, SLOT(showRomMenu(const QPoint &)));
+    }
 
-    connect(gameGridItem, SIGNAL(singleClicked(QWidget*)), this, SLOT(highlightGridWidget(QWidget*)));
-    connect(gameGridItem, SIGNAL(doubleClicked(QWidget*)), parent, SLOT(launchRomFromWidget(QWidget*)));
-    connect(gameGridItem, SIGNAL(arrowPressed(QWidget*, QString)), this, SLOT(selectNextRom(QWidget*, QString)));
-    connect(gameGridItem, SIGNAL(enterPressed(QWidget*)), parent, SLOT(launchRomFromWidget(QWidget*)));
-    connect(gameGridItem, SIGNAL(customContextMenuRequested(const QPoint &)), parent, SLOT(showRomMenu(const QPoint &)));
+    gridWidget->adjustSize();
+    gridWidget->setUpdatesEnabled(true);
 }
 
 
@@ -202,6 +214,21 @@ QWidget *GridView::getCurrentRomWidget()
 }
 
 
+QPixmap GridView::getRomImage(Rom *currentRom, QSize imageSize)
+{
+    //Use uniform aspect ratio to account for fluctuations in TheGamesDB box art
+    Qt::AspectRatioMode aspectRatioMode = Qt::IgnoreAspectRatio;
+
+    //Don't warp aspect ratio though if image is too far away from standard size (JP box art)
+    double aspectRatio = double(currentRom->image.width()) / currentRom->image.height();
+
+    if (aspectRatio < 1.1 || aspectRatio > 1.8)
+        aspectRatioMode = Qt::KeepAspectRatio;
+
+    return QPixmap::fromImage(currentRom->image.scaled(imageSize, aspectRatioMode, Qt::SmoothTransformation));
+}
+
+
 bool GridView::hasSelectedRom()
 {
     return gridCurrent;
@@ -373,3 +400,26 @@ void GridView::updateGridColumns(int width)
     gridWidget->adjustSize();
 }
 
+
+void GridView::updateRom(Rom *currentRom)
+{
+    QSize imageSize = getImageSize("Grid");
+    QString labelText = SETTINGS.value("Grid/labeltext","Filename").toString();
+
+    for (int i = 0; i < gridLayout->count(); i++)
+    {
+        QWidget *gameGridItem = gridLayout->itemAt(i)->widget();
+
+        if (gameGridItem == nullptr || gameGridItem->property("romMD5").toString() != currentRom->romMD5)
+            continue;
+
+        QLabel *gridImageLabel = gameGridItem->findChild<QLabel*>("gridImageLabel");
+        QLabel *gridTextLabel = gameGridItem->findChild<QLabel*>("gridTextLabel");
+
+        if (gridImageLabel != nullptr && currentRom->imageExists)
+            gridImageLabel->setPixmap(getRomImage(currentRom, imageSize));
+
+        if (gridTextLabel != nullptr)
+            gridTextLabel->setText(getRomInfo(labelText, currentRom));
+    }
+}
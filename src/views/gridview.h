@@ -44,7 +44,7 @@ class GridView : public QScrollArea
 
 public:
     explicit GridView(QWidget *parent = 0);
-    void addToGridView(Rom *currentRom, int count, bool ddEnabled);
+    void addToGridView(Rom *roms, int first, int count, bool ddEnabled);
     int getCurrentRom();
     QString getCurrentRomInfo(QString infoName);
     QWidget *getCurrentRomWidget();
@@ -52,6 +52,7 @@ public:
     void resetView();
     void saveGridPosition();
     void setGridBackground();
+    void updateRom(Rom *currentRom);
 
 protected:
     void keyPressEvent(QKeyEvent *event);
@@ -61,6 +62,7 @@ signals:
     void gridItemSelected(bool active);
 
 private:
+    QPixmap getRomImage(Rom *currentRom, QSize imageSize);
     void updateGridColumns(int width);
 
     int autoColumnCount;
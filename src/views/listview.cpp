@@ -70,126 +70,128 @@ ListView::ListView(QWidget *parent) : QScrollArea(parent)
 }
 
 
-void ListView::addToListView(Rom *currentRom, int count, bool ddEnabled)
+void ListView::addToListView(Rom *roms, int first, int count, bool ddEnabled)
 {
-    if (ddEnabled) // Add place for "No Cart" entry
-        count++;
-
     QStringList visible = SETTINGS.value("List/columns", "Filename|Internal Name|Size").toString().split("|");
+    bool displayCover = SETTINGS.value("List/displaycover", "") == "true";
 
-    if (visible.join("") == "" && SETTINGS.value("List/displaycover", "") != "true")
+    if (visible.join("") == "" && !displayCover)
         //Otherwise no columns, so don't bother populating
         return;
 
-    ClickableWidget *gameListItem = new ClickableWidget(listWidget);
-    gameListItem->setContentsMargins(0, 0, 20, 0);
-    gameListItem->setContextMenuPolicy(Qt::CustomContextMenu);
-    if (SETTINGS.value("List/theme","Light").toString() == "Dark")
-        gameListItem->setStyleSheet("color:#EEE;");
-
-    //Assign ROM data to widget for use in click events
-    gameListItem->setProperty("fileName", currentRom->fileName);
-    gameListItem->setProperty("directory", currentRom->directory);
-    if (currentRom->goodName == getTranslation("Unknown ROM") ||
-        currentRom->goodName == getTranslation("Requires catalog file"))
-        gameListItem->setProperty("search", currentRom->internalName);
-    else
-        gameListItem->setProperty("search", currentRom->goodName);
-    gameListItem->setProperty("romMD5", currentRom->romMD5);
-    gameListItem->setProperty("zipFile", currentRom->zipFile);
-
-    QGridLayout *gameListLayout = new QGridLayout(gameListItem);
-    gameListLayout->setColumnStretch(3, 1);
-
-    //Add image
-    if (SETTINGS.value("List/displaycover", "") == "true") {
-        QLabel *listImageLabel = new QLabel(gameListItem);
-        listImageLabel->setMinimumHeight(getImageSize("List").height());
-        listImageLabel->setMinimumWidth(getImageSize("List").width());
-
-        QPixmap image;
-
-        if (currentRom->imageExists)
-            image = currentRom->image.scaled(getImageSize("List"), Qt::KeepAspectRatio,
-                                            Qt::SmoothTransformation);
-        else {
-            if (ddEnabled && count == 0)
-                image = QPixmap(":/images/no-cart.png").scaled(getImageSize("List"), Qt::KeepAspectRatio,
-                                                                 Qt::SmoothTransformation);
-            else
-                image = QPixmap(":/images/not-found.png").scaled(getImageSize("List"), Qt::KeepAspectRatio,
-                                                                 Qt::SmoothTransformation);
-        }
+    //Settings are the same for the whole batch, so only look them up once
+    bool darkTheme = SETTINGS.value("List/theme","Light").toString() == "Dark";
+    bool firstItemHeader = SETTINGS.value("List/firstitemheader","true") == "true";
+    QSize imageSize = getImageSize("List");
+    int textSize = getTextSize();
 
-        listImageLabel->setPixmap(image);
-        listImageLabel->setAlignment(Qt::AlignCenter);
-        gameListLayout->addWidget(listImageLabel, 0, 1);
-    }
-
-    //Create text label
-    QLabel *listTextLabel = new QLabel("", gameListItem);
-    QString listText = "";
+    QPixmap noCartImage, notFoundImage;
 
-    int i = 0;
+    //Hold off on painting and layout until the whole batch is in
+    listWidget->setUpdatesEnabled(false);
 
-    foreach (QString current, visible)
+    for (int r = 0; r < count; r++)
     {
-        QString addition = "";
-
-        if (i == 0 && SETTINGS.value("List/firstitemheader","true") == "true")
-            addition += "<h2 style='line-height:120%;margin:0;padding:0;'>";
-        else
-            addition += "<div style='line-height:120%;margin:0;padding:0;'><b>"
-                     + getTranslation(current) + ":</b> ";
-
-        addition += getRomInfo(current, currentRom, true);
-
-        if (i == 0 && SETTINGS.value("List/firstitemheader","true") == "true")
-            addition += "</h2>";
+        Rom *currentRom = &roms[r];
+        int position = first + r;
+
+        if (ddEnabled) // Add place for "No Cart" entry
+            position++;
+
+        bool noCart = ddEnabled && position == 0;
+
+        ClickableWidget *gameListItem = new ClickableWidget(listWidget);
+        gameListItem->setContentsMargins(0, 0, 20, 0);
+        gameListItem->setContextMenuPolicy(Qt::CustomContextMenu);
+        if (darkTheme)
+            gameListItem->setStyleSheet("color:#EEE;");
+
+        //Assign ROM data to widget for use in click events
+        gameListItem->setProperty("fileName", currentRom->fileName);
+        gameListItem->setProperty("directory", currentRom->directory);
+        if (currentRom->goodName == getTranslation("Unknown ROM") ||
+            currentRom->goodName == getTranslation("Requires catalog file"))
+            gameListItem->setProperty("search", currentRom->internalName);
         else
-            addition += "</div>";
+            gameListItem->setProperty("search", currentRom->goodName);
+        gameListItem->setProperty("romMD5", currentRom->romMD5);
+        gameListItem->setProperty("zipFile", currentRom->zipFile);
+
+        QGridLayout *gameListLayout = new QGridLayout(gameListItem);
+        gameListLayout->setColumnStretch(3, 1);
+
+        //Add image
+        if (displayCover) {
+            QLabel *listImageLabel = new QLabel(gameListItem);
+            listImageLabel->setObjectName("listImageLabel");
+            listImageLabel->setMinimumHeight(imageSize.height());
+            listImageLabel->setMinimumWidth(imageSize.width());
+
+            QPixmap image;
+
+            if (currentRom->imageExists)
+                image = QPixmap::fromImage(currentRom->image.scaled(imageSize, Qt::KeepAspectRatio,
+                                                                    Qt::SmoothTransformation));
+            else if (noCart) {
+                if (noCartImage.isNull())
+                    noCartImage = QPixmap(":/images/no-cart.png").scaled(imageSize, Qt::KeepAspectRatio,
+                                                                          Qt::SmoothTransformation);
+                image = noCartImage;
+            } else {
+                if (notFoundImage.isNull())
+                    notFoundImage = QPixmap(":/images/not-found.png").scaled(imageSize, Qt::KeepAspectRatio,
+                                                                             Qt::SmoothTransformation);
+                image = notFoundImage;
+            }
+
+            listImageLabel->setPixmap(image);
+            listImageLabel->setAlignment(Qt::AlignCenter);
+            gameListLayout->addWidget(listImageLabel, 0, 1);
+        }
 
-        if (addition.right(12) != ":</b> </div>")
-            listText += addition;
+        //Create text label
+        QLabel *listTextLabel = new QLabel("", gameListItem);
+        listTextLabel->setObjectName("listTextLabel");
+        QString listText = getRomText(currentRom, visible, firstItemHeader);
+
+        if (noCart)
+            listText = "<h2>" + tr("No Cart") + "</h2>";
+
+        listTextLabel->setText(listText);
+        listTextLabel->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
+        listTextLabel->setWordWrap(true);
+        QFont font = listTextLabel->font();
+        font.setPointSize(textSize);
+        listTextLabel->setFont(font);
+        gameListLayout->addWidget(listTextLabel, 0, 3);
+
+        gameListLayout->setColumnMinimumWidth(0, 20);
+        gameListLayout->setColumnMinimumWidth(2, 10);
+        gameListItem->setLayout(gameListLayout);
+
+        if (position != 0) {
+            QFrame *separator = new QFrame();
+            separator->setFrameShape(QFrame::HLine);
+            separator->setStyleSheet("margin:0;padding:0;");
+            QPalette palette = separator->palette();
+            if (darkTheme)
+                palette.setColor(QPalette::Window, Qt::black);
+            else
+                palette.setColor(QPalette::Window, Qt::gray);
+            separator->setPalette(palette);
+            listLayout->addWidget(separator);
+        }
 
-        i++;
-    }
+        listLayout->addWidget(gameListItem);
 
-    if (ddEnabled && count == 0)
-        listText = "<h2>" + tr("No Cart") + "</h2>";
-
-    listTextLabel->setText(listText);
-    listTextLabel->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
-    listTextLabel->setWordWrap(true);
-    QFont font = listTextLabel->font();
-    font.setPointSize(getTextSize());
-    listTextLabel->setFont(font);
-    gameListLayout->addWidget(listTextLabel, 0, 3);
-
-    gameListLayout->setColumnMinimumWidth(0, 20);
-    gameListLayout->setColumnMinimumWidth(2, 10);
-    gameListItem->setLayout(gameListLayout);
-
-    if (count != 0) {
-        QFrame *separator = new QFrame();
-        separator->setFrameShape(QFrame::HLine);
-        separator->setStyleSheet("margin:0;padding:0;");
-        QPalette palette = separator->palette();
-        if (SETTINGS.value("List/theme","Light").toString() == "Dark")
-            palette.setColor(QPalette::Window, Qt::black);
-        else
-            palette.setColor(QPalette::Window, Qt::gray);
-        separator->setPalette(palette);
-        listLayout->addWidget(separator);
+        connect(gameListItem, SIGNAL(singleClicked(QWidget*)), this, SLOT(highlightListWidget(QWidget*)));
+        connect(gameListItem, SIGNAL(doubleClicked(QWidget*)), parent, SLOT(launchRomFromWidget(QWidget*)));
+        connect(gameListItem, SIGNAL(arrowPressed(QWidget*, QString)), this, SLOT(selectNextRom(QWidget*, QString)));
+        connect(gameListItem, SIGNAL(enterPressed(QWidget*)), parent, SLOT(launchRomFromWidget(QWidget*)));
+        connect(gameListItem, SIGNAL(customContextMenuRequested(const QPoint &)), parent, SLOT(showRomMenu(const QPoint &)));
     }
 
-    listLayout->addWidget(gameListItem);
-
-    connect(gameListItem, SIGNAL(singleClicked(QWidget*)), this, SLOT(highlightListWidget(QWidget*)));
-    connect(gameListItem, SIGNAL(doubleClicked(QWidget*)), parent, SLOT(launchRomFromWidget(QWidget*)));
-    connect(gameListItem, SIGNAL(arrowPressed(QWidget*, QString)), this, SLOT(selectNextRom(QWidget*, QString)));
-    connect(gameListItem, SIGNAL(enterPressed(QWidget*)), parent, SLOT(launchRomFromWidget(QWidget*)));
-    connect(gameListItem, SIGNAL(customContextMenuRequested(const QPoint &)), parent, SLOT(showRomMenu(const QPoint &)));
+    listWidget->setUpdatesEnabled(true);
 }
 
 
@@ -215,6 +217,39 @@ QWidget *ListView::getCurrentRomWidget()
 }
 
 
+QString ListView::getRomText(Rom *currentRom, QStringList visible, bool firstItemHeader)
+{
+    QString listText = "";
+
+    int i = 0;
+
+    foreach (QString current, visible)
+    {
+        QString addition = "";
+
+        if (i == 0 && firstItemHeader)
+            addition += "<h2 style='line-height:120%;margin:0;padding:0;'>";
+        else
+            addition += "<div style='line-height:120%;margin:0;padding:0;'><b>"
+                     + getTranslation(current) + ":</b> ";
+
+        addition += getRomInfo(current, currentRom, true);
+
+        if (i == 0 && firstItemHeader)
+            addition += "</h2>";
+        else
+            addition += "</div>";
+
+        if (addition.right(12) != ":</b> </div>")
+            listText += addition;
+
+        i++;
+    }
+
+    return listText;
+}
+
+
 bool ListView::hasSelectedRom()
 {
     return listCurrent;
@@ -328,3 +363,29 @@ void ListView::setListPosition()
             highlightListWidget(checkWidget);
     }
 }
+
+
+void ListView::updateRom(Rom *currentRom)
+{
+    QStringList visible = SETTINGS.value("List/columns", "Filename|Internal Name|Size").toString().split("|");
+    bool firstItemHeader = SETTINGS.value("List/firstitemheader","true") == "true";
+    QSize imageSize = getImageSize("List");
+
+    for (int i = 0; i < listLayout->count(); i++)
+    {
+        QWidget *gameListItem = listLayout->itemAt(i)->widget();
+
+        if (gameListItem == nullptr || gameListItem->property("romMD5").toString() != currentRom->romMD5)
+            continue;
+
+        QLabel *listImageLabel = gameListItem->findChild<QLabel*>("listImageLabel");
+        QLabel *listTextLabel = gameListItem->findChild<QLabel*>("listTextLabel");
+
+        if (listImageLabel != nullptr && currentRom->imageExists)
+            listImageLabel->setPixmap(QPixmap::fromImage(currentRom->image.scaled(imageSize, Qt::KeepAspectRatio,
+                                                                                  Qt::SmoothTransformation)));
+
+        if (listTextLabel != nullptr)
+            listTextLabel->setText(getRomText(currentRom, visible, firstItemHeader));
+    }
+}
@@ -44,7 +44,7 @@ class ListView : public QScrollArea
 
 public:
     explicit ListView(QWidget *parent = 0);
-    void addToListView(Rom *currentRom, int count, bool ddEnabled);
+    void addToListView(Rom *roms, int first, int count, bool ddEnabled);
     int getCurrentRom();
     QString getCurrentRomInfo(QString infoName);
     QWidget *getCurrentRomWidget();
@@ -52,6 +52,7 @@ public:
     void resetView();
     void saveListPosition();
     void setListBackground();
+    void updateRom(Rom *currentRom);
 
 protected:
     void keyPressEvent(QKeyEvent *event);
@@ -60,6 +61,8 @@ signals:
     void listItemSelected(bool active);
 
 private:
+    QString getRomText(Rom *currentRom, QStringList visible, bool firstItemHeader);
+
     int currentListRom;
     bool listCurrent;
     int savedListRom;
@@ -85,99 +85,68 @@ void TableView::addNoCartRow()
 }
 
 
-void TableView::addToTableView(Rom *currentRom)
+void TableView::addToTableView(Rom *roms, int count)
 {
     QStringList visible = SETTINGS.value("Table/columns", "Filename|Size").toString().split("|");
 
     if (visible.join("") == "") //Otherwise no columns, so don't bother populating
         return;
 
-    fileItem = new TreeWidgetItem(this);
-
-    //Filename for launching ROM
-    fileItem->setText(0, currentRom->fileName);
-
-    //Directory ROM is located in
-    fileItem->setText(1, currentRom->directory);
-
-    //GoodName or Internal Name for searching
-    if (currentRom->goodName == getTranslation("Unknown ROM") ||
-        currentRom->goodName == getTranslation("Requires catalog file"))
-        fileItem->setText(2, currentRom->internalName);
-    else
-        fileItem->setText(2, currentRom->goodName);
+    int c = visible.indexOf("Game Cover") + 5;
+    bool addImage = c >= 5;
+    QSize imageSize = getImageSize("Table");
 
-    //MD5 for cache info
-    fileItem->setText(3, currentRom->romMD5.toLower());
+    QList<QTreeWidgetItem*> items;
 
-    //Zip file
-    fileItem->setText(4, currentRom->zipFile);
-
-    int i = 5, c = 0;
-    bool addImage = false;
-
-    foreach (QString current, visible)
+    for (int r = 0; r < count; r++)
     {
-        QString text = getRomInfo(current, currentRom);
-        fileItem->setText(i, text);
+        Rom *currentRom = &roms[r];
 
-        if (current == "GoodName" || current == "Game Title") {
-            if (text == getTranslation("Unknown ROM") ||
-                text == getTranslation("Requires catalog file") ||
-                text == getTranslation("Not found")) {
-                fileItem->setForeground(i, QBrush(Qt::gray));
-                fileItem->setData(i, Qt::UserRole, "ZZZ"); //end of sorting
-            } else
-                fileItem->setData(i, Qt::UserRole, text);
-        }
+        //Build items detached from the table so they can be inserted in one go
+        fileItem = new TreeWidgetItem();
 
-        if (current == "Size")
-            fileItem->setData(i, Qt::UserRole, currentRom->sortSize);
+        //Filename for launching ROM
+        fileItem->setText(0, currentRom->fileName);
 
-        if (current == "Release Date")
-            fileItem->setData(i, Qt::UserRole, currentRom->sortDate);
+        //Directory ROM is located in
+        fileItem->setText(1, currentRom->directory);
 
-        if (current == "Game Cover") {
-            c = i;
-            addImage = true;
-        }
+        //GoodName or Internal Name for searching
+        if (currentRom->goodName == getTranslation("Unknown ROM") ||
+            currentRom->goodName == getTranslation("Requires catalog file"))
+            fileItem->setText(2, currentRom->internalName);
+        else
+            fileItem->setText(2, currentRom->goodName);
 
-        QStringList center, right;
+        //MD5 for cache info
+        fileItem->setText(3, currentRom->romMD5.toLower());
 
-        center << "MD5" << "CRC1" << "CRC2" << "Rumble" << "ESRB" << "Genre" << "Publisher" << "Developer";
-        right << "Size" << "Players" << "Save Type" << "Release Date" << "Rating";
+        //Zip file
+        fileItem->setText(4, currentRom->zipFile);
 
-        if (center.contains(current))
-            fileItem->setTextAlignment(i, Qt::AlignHCenter | Qt::AlignVCenter);
-        else if (right.contains(current))
-            fileItem->setTextAlignment(i, Qt::AlignRight | Qt::AlignVCenter);
+        setRomData(fileItem, currentRom, visible);
 
-        i++;
+        items << fileItem;
     }
 
-    addTopLevelItem(fileItem);
-
-
-    if (currentRom->imageExists && addImage) {
-        QPixmap image(currentRom->image.scaled(getImageSize("Table"), Qt::KeepAspectRatio,
-                                              Qt::SmoothTransformation));
-
-        QWidget *imageContainer = new QWidget(this);
-        QGridLayout *imageGrid = new QGridLayout(imageContainer);
-        QLabel *imageLabel = new QLabel(imageContainer);
+    //Resorting after every row is what makes large collections slow, so only sort once at the end
+    setUpdatesEnabled(false);
+    setSortingEnabled(false);
+    addTopLevelItems(items);
 
-        imageLabel->setPixmap(image);
-        imageGrid->addWidget(imageLabel, 1, 1);
-        imageGrid->setColumnStretch(0, 1);
-        imageGrid->setColumnStretch(2, 1);
-        imageGrid->setRowStretch(0, 1);
-        imageGrid->setRowStretch(2, 1);
-        imageGrid->setContentsMargins(0,0,0,0);
+    //Item widgets can only be set once the item is part of the table
+    if (addImage) {
+        for (int r = 0; r < count; r++)
+        {
+            Rom *currentRom = &roms[r];
 
-        imageContainer->setLayout(imageGrid);
-
-        setItemWidget(fileItem, c, imageContainer);
+            if (currentRom->imageExists)
+                setRomCover(items.at(r), c, currentRom, imageSize);
+        }
     }
+
+    setSortingEnabled(true);
+    setUpdatesEnabled(true);
 }
 
 
@@ -330,6 +299,77 @@ void TableView::saveTablePosition()
 }
 
 
+void TableView::setRomCover(QTreeWidgetItem *item, int column, Rom *currentRom, QSize imageSize)
+{
+    QPixmap image(QPixmap::fromImage(currentRom->image.scaled(imageSize, Qt::KeepAspectRatio,
+                                                              Qt::SmoothTransformation)));
+
+    QWidget *imageContainer = new QWidget(this);
+    QGridLayout *imageGrid = new QGridLayout(imageContainer);
+    QLabel *imageLabel = new QLabel(imageContainer);
+
+    imageLabel->setPixmap(image);
+    imageGrid->addWidget(imageLabel, 1, 1);
+    imageGrid->setColumnStretch(0, 1);
+    imageGrid->setColumnStretch(2, 1);
+    imageGrid->setRowStretch(0, 1);
+    imageGrid->setRowStretch(2, 1);
+    imageGrid->setContentsMargins(0,0,0,0);
+
+    imageContainer->setLayout(imageGrid);
+
+    setItemWidget(item, column, imageContainer);
+}
+
+
+void TableView::setRomData(QTreeWidgetItem *item, Rom *currentRom, QStringList visible)
+{
+    QStringList center, right;
+
+    center << "MD5" << "CRC1" << "CRC2" << "Rumble" << "ESRB" << "Genre" << "Publisher" << "Developer";
+    right << "Size" << "Players" << "Save Type" << "Release Date" << "Rating" << "Last Played" << "Times Played";
+
+    int i = 5;
+
+    foreach (QString current, visible)
+    {
+        QString text = getRomInfo(current, currentRom);
+        item->setText(i, text);
+
+        if (current == "GoodName" || current == "Game Title") {
+            if (text == getTranslation("Unknown ROM") ||
+                text == getTranslation("Requires catalog file") ||
+                text == getTranslation("Not found")) {
+                item->setForeground(i, QBrush(Qt::gray));
+                item->setData(i, Qt::UserRole, "ZZZ"); //end of sorting
+            } else {
+                item->setData(i, Qt::ForegroundRole, QVariant());
+                item->setData(i, Qt::UserRole, text);
+            }
+        }
+
+        if (current == "Size")
+            item->setData(i, Qt::UserRole, currentRom->sortSize);
+
+        if (current == "Release Date")
+            item->setData(i, Qt::UserRole, currentRom->sortDate);
+
+        if (current == "Last Played") //Seconds, TreeWidgetItem compares these as int
+            item->setData(i, Qt::UserRole, int(currentRom->lastPlayed / 1000));
+
+        if (current == "Times Played")
+            item->setData(i, Qt::UserRole, currentRom->playCount);
+
+        if (center.contains(current))
+            item->setTextAlignment(i, Qt::AlignHCenter | Qt::AlignVCenter);
+        else if (right.contains(current))
+            item->setTextAlignment(i, Qt::AlignRight | Qt::AlignVCenter);
+
+        i++;
+    }
+}
+
+
 void TableView::setTablePosition()
 {
     horizontalScrollBar()->setValue(positionx);
@@ -345,3 +385,26 @@ void TableView::setTablePosition()
         }
     }
 }
+
+
+void TableView::updateRom(Rom *currentRom)
+{
+    QStringList visible = SETTINGS.value("Table/columns", "Filename|Size").toString().split("|");
+
+    if (visible.join("") == "") //No columns, so nothing was populated
+        return;
+
+    int c = visible.indexOf("Game Cover") + 5;
+
+    for (int i = 0; i < topLevelItemCount(); i++)
+    {
+        QTreeWidgetItem *item = topLevelItem(i);
+
+        if (item->text(3) == currentRom->romMD5.toLower()) {
+            setRomData(item, currentRom, visible);
+
+            if (c >= 5 && currentRom->imageExists)
+                setRomCover(item, c, currentRom, getImageSize("Table"));
+        }
+    }
+}
@@ -45,12 +45,13 @@ class TableView : public QTreeWidget
 public:
     explicit TableView(QWidget *parent = 0);
     void addNoCartRow();
-    void addToTableView(Rom *currentRom);
+    void addToTableView(Rom *roms, int count);
     QString getCurrentRomInfo(QString infoName);
     bool hasSelectedRom();
     void resetView(bool imageUpdated);
     void saveColumnWidths();
     void saveTablePosition();
+    void updateRom(Rom *currentRom);
 
 protected:
     void keyPressEvent(QKeyEvent *event);
@@ -60,6 +61,9 @@ signals:
     void tableActive();
 
 private:
+    void setRomCover(QTreeWidgetItem *item, int column, Rom *currentRom, QSize imageSize);
+    void setRomData(QTreeWidgetItem *item, Rom *currentRom, QStringList visible);
+
     int positionx;
     int positiony;
     int savedTableRom;
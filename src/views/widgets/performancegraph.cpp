@@ -0,0 +1,163 @@
+/***
+ * Copyright (c) 2013, Dan Hasting
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "performancegraph.h"
+
+#include "../../global.h"
+
+#include <QPainter>
+#include <QPaintEvent>
+#include <QTimer>
+
+
+PerformanceGraph::PerformanceGraph(QWidget *parent) : QWidget(parent)
+{
+    //CEN64 reports about once a second, so this holds the last five minutes
+    samples.resize(300);
+    points.reserve(samples.size());
+
+    stallThreshold = SETTINGS.value("Other/stallthreshold", 45).toDouble();
+
+    //Samples only mark the graph dirty, it is redrawn at a fixed rate
+    repaintTimer = new QTimer(this);
+    repaintTimer->setInterval(250);
+
+    connect(repaintTimer, SIGNAL(timeout()), this, SLOT(repaintIfDirty()));
+
+    setBackgroundRole(QPalette::Base);
+    setAutoFillBackground(true);
+    clear();
+}
+
+
+void PerformanceGraph::addSample(TelemetrySample sample)
+{
+    samples[next] = sample;
+    next = (next + 1) % samples.size();
+    count = qMin(count + 1, samples.size());
+
+    dirty = true;
+
+    if (!repaintTimer->isActive())
+        repaintTimer->start();
+}
+
+
+void PerformanceGraph::clear()
+{
+    count = 0;
+    next = 0;
+    dirty = false;
+
+    stallThreshold = SETTINGS.value("Other/stallthreshold", 45).toDouble();
+
+    repaintTimer->stop();
+    update();
+}
+
+
+void PerformanceGraph::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    painter.setClipRect(event->rect());
+
+    QRect area = rect().adjusted(5, 20, -5, -5);
+
+    if (count == 0) {
+        painter.setPen(palette().color(QPalette::Disabled, QPalette::Text));
+        painter.drawText(rect(), Qt::AlignCenter, tr("No performance data"));
+        return;
+    }
+
+    double peak = stallThreshold;
+    for (int i = 0; i < count; i++)
+        peak = qMax(peak, sampleAt(i).viPerSecond);
+    peak *= 1.1;
+
+    double step = double(area.width()) / qMax(1, samples.size() - 1);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    //Stall threshold
+    double thresholdY = area.bottom() - stallThreshold / peak * area.height();
+    painter.setPen(QPen(palette().color(QPalette::Mid), 1, Qt::DashLine));
+    painter.drawLine(QPointF(area.left(), thresholdY), QPointF(area.right(), thresholdY));
+
+    //Speed over time, newest on the right
+    points.resize(count);
+    for (int i = 0; i < count; i++)
+    {
+        double x = area.right() - (count - 1 - i) * step;
+        double y = area.bottom() - sampleAt(i).viPerSecond / peak * area.height();
+        points[i] = QPointF(x, y);
+    }
+
+    painter.setPen(QPen(palette().color(QPalette::Highlight), 2));
+    painter.drawPolyline(points.constData(), points.size());
+
+    //Mark the dips below the threshold
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor(Qt::red));
+    for (int i = 0; i < count; i++)
+        if (sampleAt(i).viPerSecond < stallThreshold)
+            painter.drawEllipse(points.at(i), 3, 3);
+
+    const TelemetrySample &latest = sampleAt(count - 1);
+    painter.setPen(palette().color(QPalette::Text));
+    painter.drawText(rect().adjusted(5, 2, -5, 0), Qt::AlignLeft | Qt::AlignTop,
+                     QString("VI/s: %1    MHz: %2").arg(latest.viPerSecond, 0, 'f', 2)
+                                                 .arg(latest.mhz, 0, 'f', 2));
+}
+
+
+void PerformanceGraph::repaintIfDirty()
+{
+    if (!dirty) {
+        repaintTimer->stop();
+        return;
+    }
+
+    dirty = false;
+    update();
+}
+
+
+const TelemetrySample &PerformanceGraph::sampleAt(int index) const
+{
+    //Index 0 is the oldest sample still in the ring
+    int first = (next - count + samples.size()) % samples.size();
+    return samples.at((first + index) % samples.size());
+}
+
+
+QSize PerformanceGraph::sizeHint() const
+{
+    return QSize(400, 120);
+}
@@ -0,0 +1,191 @@
+/***
+ * Copyright (c) 2013, Dan Hasting
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "sessionlist.h"
+
+#include "../../global.h"
+#include "../../dialogs/logdialog.h"
+#include "../../emulation/emulatorhandler.h"
+#include "../../emulation/emulatorsession.h"
+#include "../../emulation/telemetry.h"
+
+#include <QGridLayout>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QTime>
+#include <QTimer>
+#include <QTreeWidget>
+
+
+SessionList::SessionList(EmulatorHandler *emulation, QWidget *parent) : QWidget(parent)
+{
+    this->emulation = emulation;
+
+    QStringList headers;
+    headers << tr("ROM") << tr("VI/s") << tr("MHz") << tr("Time");
+
+    sessionTree = new QTreeWidget(this);
+    sessionTree->setHeaderLabels(headers);
+    sessionTree->setRootIsDecorated(false);
+    sessionTree->setAllColumnsShowFocus(true);
+    sessionTree->header()->setStretchLastSection(false);
+    sessionTree->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+
+    logButton = new QPushButton(tr("View Log..."), this);
+    stopButton = new QPushButton(tr("St&op"), this);
+    stopButton->setIcon(QIcon::fromTheme("media-playback-stop"));
+
+    QGridLayout *layout = new QGridLayout(this);
+    layout->setContentsMargins(5, 5, 5, 5);
+    layout->addWidget(sessionTree, 0, 0, 1, 3);
+    layout->addWidget(logButton, 1, 1);
+    layout->addWidget(stopButton, 1, 2);
+    layout->setColumnStretch(0, 1);
+    setLayout(layout);
+
+    //CEN64 reports about once a second, there's nothing new to show faster than that
+    speedTimer = new QTimer(this);
+    speedTimer->setInterval(1000);
+
+    connect(speedTimer, SIGNAL(timeout()), this, SLOT(updateSpeed()));
+    connect(sessionTree, SIGNAL(itemSelectionChanged()), this, SLOT(selectSession()));
+    connect(logButton, SIGNAL(clicked()), this, SLOT(openLog()));
+    connect(stopButton, SIGNAL(clicked()), this, SLOT(stopSession()));
+
+    refresh();
+}
+
+
+void SessionList::addSession(EmulatorSession *session)
+{
+    QTreeWidgetItem *item = new QTreeWidgetItem(sessionTree);
+    item->setText(0, session->getName());
+    item->setData(0, Qt::UserRole, session->getID());
+
+    for (int i = 1; i < sessionTree->columnCount(); i++)
+        item->setTextAlignment(i, Qt::AlignRight | Qt::AlignVCenter);
+
+    //Follow the newest game, the user can pick another one from the list
+    sessionTree->setCurrentItem(item);
+
+    updateSpeed();
+    speedTimer->start();
+}
+
+
+EmulatorSession *SessionList::getCurrentSession()
+{
+    return getSession(sessionTree->currentItem());
+}
+
+
+EmulatorSession *SessionList::getSession(QTreeWidgetItem *item)
+{
+    if (!item)
+        return nullptr;
+
+    //Items hold the session ID, a finished session may already be gone
+    int id = item->data(0, Qt::UserRole).toInt();
+
+    foreach (EmulatorSession *session, emulation->getSessions())
+        if (session->getID() == id)
+            return session;
+
+    return nullptr;
+}
+
+
+void SessionList::openLog()
+{
+    EmulatorSession *session = getCurrentSession();
+
+    if (session) {
+        LogDialog logDialog(session->getLog(), this);
+        logDialog.exec();
+    }
+}
+
+
+void SessionList::refresh()
+{
+    for (int i = sessionTree->topLevelItemCount() - 1; i >= 0; i--)
+    {
+        if (!getSession(sessionTree->topLevelItem(i)))
+            delete sessionTree->takeTopLevelItem(i);
+    }
+
+    if (sessionTree->topLevelItemCount() == 0)
+        speedTimer->stop();
+
+    selectSession();
+}
+
+
+void SessionList::selectSession()
+{
+    EmulatorSession *session = getCurrentSession();
+
+    logButton->setEnabled(session != nullptr);
+    stopButton->setEnabled(session != nullptr);
+
+    emit sessionSelected(session);
+}
+
+
+void SessionList::stopSession()
+{
+    EmulatorSession *session = getCurrentSession();
+
+    if (session)
+        session->stop();
+}
+
+
+void SessionList::updateSpeed()
+{
+    for (int i = 0; i < sessionTree->topLevelItemCount(); i++)
+    {
+        QTreeWidgetItem *item = sessionTree->topLevelItem(i);
+        EmulatorSession *session = getSession(item);
+
+        if (!session)
+            continue;
+
+        TelemetrySample sample = session->getTelemetry()->getLastSample();
+
+        if (sample.time > 0) {
+            item->setText(1, QString::number(sample.viPerSecond, 'f', 2));
+            item->setText(2, QString::number(sample.mhz, 'f', 2));
+        }
+
+        item->setText(3, QTime(0, 0).addMSecs(session->getRunningTime()).toString("h:mm:ss"));
+    }
+}
@@ -0,0 +1,75 @@
+/***
+ * Copyright (c) 2013, Dan Hasting
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#ifndef SESSIONLIST_H
+#define SESSIONLIST_H
+
+#include <QWidget>
+
+class QPushButton;
+class QTimer;
+class QTreeWidget;
+class QTreeWidgetItem;
+class EmulatorHandler;
+class EmulatorSession;
+
+
+class SessionList : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit SessionList(EmulatorHandler *emulation, QWidget *parent = 0);
+    EmulatorSession *getCurrentSession();
+
+public slots:
+    void addSession(EmulatorSession *session);
+    void refresh();
+
+signals:
+    void sessionSelected(EmulatorSession *session);
+
+private:
+    EmulatorSession *getSession(QTreeWidgetItem *item);
+
+    EmulatorHandler *emulation;
+    QPushButton *logButton;
+    QPushButton *stopButton;
+    QTimer *speedTimer;
+    QTreeWidget *sessionTree;
+
+private slots:
+    void openLog();
+    void selectSession();
+    void stopSession();
+    void updateSpeed();
+};
+
+#endif // SESSIONLIST_H
@@ -38,6 +38,7 @@
 class TreeWidgetItem : public QTreeWidgetItem
 {
 public:
+    TreeWidgetItem() : QTreeWidgetItem() {}
     TreeWidgetItem(QTreeWidget *parent) : QTreeWidgetItem(parent) {}
     bool operator< (const QTreeWidgetItem &other) const;
 };
@@ -0,0 +1,43 @@
+QT       += core network testlib widgets concurrent
+
+CONFIG   += testcase console
+CONFIG   -= app_bundle
+
+TARGET = tst_scraper
+TEMPLATE = app
+
+
+SOURCES += tst_scraper.cpp \
+    stubserver.cpp \
+    ../../src/common.cpp \
+    ../../src/roms/networkclient.cpp \
+    ../../src/roms/thegamesdbscraper.cpp
+
+HEADERS += stubserver.h \
+    ../../src/global.h \
+    ../../src/common.h \
+    ../../src/roms/networkclient.h \
+    ../../src/roms/thegamesdbscraper.h
+
+DISTFILES += fixtures/*.json
+
+#common.cpp extracts zipped ROMs, so the test links QuaZIP the same way the application does
+win32|macx|linux_quazip_static {
+    DEFINES += QUAZIP_STATIC
+    LIBS += -lz
+
+    SOURCES += ../../quazip5/*.cpp
+    SOURCES += ../../quazip5/*.c
+    HEADERS += ../../quazip5/*.h
+    INCLUDEPATH += ../..
+} else {
+    system("which dpkg > /dev/null 2>&1") {
+        system("dpkg -l | grep libquazip-qt5-dev | grep ^ii > /dev/null") {
+            LIBS += -lquazip-qt5
+        } else {
+            LIBS += -lquazip5
+        }
+    } else {
+        LIBS += -lquazip5
+    }
+}
@@ -0,0 +1,252 @@
+/***
+ * Copyright (c) 2013, Dan Hasting
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "stubserver.h"
+
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrl>
+#include <QUrlQuery>
+
+
+StubServer::StubServer(QString fixtures, QObject *parent) : QTcpServer(parent)
+{
+    this->fixtures = fixtures;
+
+    delay = 500;
+    response = Success;
+
+    connect(this, SIGNAL(newConnection()), this, SLOT(acceptConnection()));
+    listen(QHostAddress::LocalHost);
+}
+
+
+void StubServer::acceptConnection()
+{
+    while (hasPendingConnections())
+    {
+        QTcpSocket *socket = nextPendingConnection();
+
+        connect(socket, SIGNAL(readyRead()), this, SLOT(readRequest()));
+        connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+    }
+}
+
+
+QByteArray StubServer::getCover()
+{
+    QImage image(4, 4, QImage::Format_RGB32);
+    image.fill(Qt::red);
+
+    QByteArray data;
+    QBuffer buffer(&data);
+
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, "PNG");
+
+    return data;
+}
+
+
+QByteArray StubServer::getFixture(QString name)
+{
+    QFile file(QDir(fixtures).absoluteFilePath(name));
+
+    file.open(QIODevice::ReadOnly);
+    QByteArray data = file.readAll();
+    file.close();
+
+    return data;
+}
+
+
+int StubServer::getGameID(QString title)
+{
+    //Numbered in the order titles are first searched for, so every game has its own ID
+    if (!titles.contains(title))
+        titles << title;
+
+    return titles.indexOf(title) + 1;
+}
+
+
+QByteArray StubServer::getGameIDResult(QStringList gameIDs)
+{
+    //ByGameID answers for every ID at once, so the games are merged into one reply
+    QJsonArray games;
+    QJsonObject boxartData;
+    QJsonObject json;
+
+    foreach (QString gameID, gameIDs)
+    {
+        int id = gameID.toInt();
+        if (id < 1 || id > titles.size())
+            continue;
+
+        json = QJsonDocument::fromJson(getSearchResult(titles.at(id - 1))).object();
+
+        games << json.value("data").toObject().value("games").toArray().first();
+        boxartData.insert(gameID, json.value("include").toObject().value("boxart").toObject()
+                                      .value("data").toObject().value(gameID));
+    }
+
+    QJsonObject data = json.value("data").toObject();
+    data.insert("count", games.size());
+    data.insert("games", games);
+    json.insert("data", data);
+
+    QJsonObject include = json.value("include").toObject();
+    QJsonObject boxart = include.value("boxart").toObject();
+    boxart.insert("data", boxartData);
+    include.insert("boxart", boxart);
+    json.insert("include", include);
+
+    return QJsonDocument(json).toJson();
+}
+
+
+int StubServer::getRequests(QString path)
+{
+    if (path == "")
+        return paths.size();
+
+    return paths.filter(path).size();
+}
+
+
+QByteArray StubServer::getSearchResult(QString title)
+{
+    //Games are named after the search so any name finds a match
+    QByteArray body = getFixture("search.json");
+    body.replace("%ID%", QByteArray::number(getGameID(title)));
+    body.replace("%TITLE%", title.toUtf8());
+    body.replace("%BASE%", getUrl().toUtf8());
+
+    return body;
+}
+
+
+QString StubServer::getUrl()
+{
+    return "http://127.0.0.1:" + QString::number(serverPort());
+}
+
+
+void StubServer::readRequest()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket*>(sender());
+
+    //Requests can arrive in pieces, only answer once the headers are complete
+    QByteArray request = socket->property("request").toByteArray() + socket->readAll();
+    socket->setProperty("request", request);
+
+    if (!request.contains("\r\n\r\n"))
+        return;
+
+    QUrl url(QString("http://localhost") + request.split(' ').value(1));
+    QString path = url.path();
+    paths << path;
+
+    if (path.endsWith("/Genres"))
+        sendReply(socket, 200, getFixture("genres.json"));
+    else if (path.endsWith("/Developers"))
+        sendReply(socket, 200, getFixture("developers.json"));
+    else if (path.endsWith("/Publishers"))
+        sendReply(socket, 200, getFixture("publishers.json"));
+    else if (path.contains("/covers/"))
+        sendReply(socket, 200, getCover(), "image/png");
+    else if (!path.contains("/Games/"))
+        sendReply(socket, 404, "{\"code\": 404, \"status\": \"Not Found\"}");
+    else if (response == NotFound)
+        sendReply(socket, 404, "{\"code\": 404, \"status\": \"Not Found\"}");
+    else if (response == Malformed)
+        sendReply(socket, 200, getFixture("malformed.json"));
+    else if (response == Empty)
+        sendReply(socket, 200, "");
+    else if (response != Timeout) {
+        QByteArray body;
+
+        if (path.endsWith("/ByGameID"))
+            body = getGameIDResult(QUrlQuery(url).queryItemValue("id").split(","));
+        else
+            body = getSearchResult(QUrlQuery(url).queryItemValue("name", QUrl::FullyDecoded));
+
+        if (response == Slow) {
+            socket->setProperty("body", body);
+
+            QTimer *timer = new QTimer(socket);
+            timer->setSingleShot(true);
+            connect(timer, SIGNAL(timeout()), this, SLOT(sendDelayed()));
+            timer->start(delay);
+        } else
+            sendReply(socket, 200, body);
+    }
+
+    //Timeout leaves the connection open without an answer until the client gives up
+}
+
+
+void StubServer::sendDelayed()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket*>(sender()->parent());
+    sendReply(socket, 200, socket->property("body").toByteArray());
+}
+
+
+void StubServer::sendReply(QTcpSocket *socket, int status, QByteArray body, QByteArray contentType)
+{
+    QByteArray reason = status == 200 ? "OK" : "Not Found";
+
+    //no-store keeps Qt's disk cache out of the way, every request has to reach the server
+    QByteArray reply = "HTTP/1.1 " + QByteArray::number(status) + " " + reason + "\r\n";
+    reply += "Content-Type: " + contentType + "\r\n";
+    reply += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    reply += "Cache-Control: no-store\r\n";
+    reply += "Connection: close\r\n\r\n";
+    reply += body;
+
+    socket->write(reply);
+    socket->disconnectFromHost();
+}
+
+
+void StubServer::setResponse(Response response, int delay)
+{
+    this->response = response;
+    this->delay = delay;
+}
@@ -0,0 +1,74 @@
+/***
+ * Copyright (c) 2013, Dan Hasting
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#ifndef STUBSERVER_H
+#define STUBSERVER_H
+
+#include <QStringList>
+#include <QTcpServer>
+
+class QTcpSocket;
+
+
+//Stands in for TheGamesDB, replaying recorded responses so the scraper can be tested offline
+class StubServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    enum Response { Success, NotFound, Malformed, Empty, Slow, Timeout };
+
+    explicit StubServer(QString fixtures, QObject *parent = 0);
+    int getGameID(QString title);
+    int getRequests(QString path = "");
+    QString getUrl();
+    void setResponse(Response response, int delay = 500);
+
+private:
+    QByteArray getCover();
+    QByteArray getFixture(QString name);
+    QByteArray getGameIDResult(QStringList gameIDs);
+    QByteArray getSearchResult(QString title);
+    void sendReply(QTcpSocket *socket, int status, QByteArray body,
+                   QByteArray contentType = "application/json");
+
+    int delay;
+    Response response;
+    QString fixtures;
+    QStringList paths;
+    QStringList titles;
+
+private slots:
+    void acceptConnection();
+    void readRequest();
+    void sendDelayed();
+};
+
+#endif // STUBSERVER_H
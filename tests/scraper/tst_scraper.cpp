@@ -0,0 +1,398 @@
+/***
+ * Copyright (c) 2013, Dan Hasting
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "stubserver.h"
+
+#include "../../src/global.h"
+#include "../../src/common.h"
+#include "../../src/roms/networkclient.h"
+#include "../../src/roms/thegamesdbscraper.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QtTest>
+
+
+class TestScraper : public QObject
+{
+    Q_OBJECT
+
+private:
+    QString getIdentifier(QString searchName);
+    QJsonObject readGameData(QString searchName);
+    bool scrape(QString searchName, int timeout = 10000);
+
+    int requests;
+    qint64 elapsed;
+    QStringList errors;
+    QTemporaryDir sandbox;
+    StubServer *server;
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanupTestCase();
+
+    void success();
+    void notFound();
+    void malformed_data();
+    void malformed();
+    void slow();
+    void timeout();
+    void bulk();
+};
+
+
+QString TestScraper::getIdentifier(QString searchName)
+{
+    return QCryptographicHash::hash(searchName.toUtf8(), QCryptographicHash::Md5).toHex();
+}
+
+
+QJsonObject TestScraper::readGameData(QString searchName)
+{
+    QFile file(getCacheLocation() + getIdentifier(searchName) + "/data.json");
+
+    if (!file.open(QIODevice::ReadOnly))
+        return QJsonObject();
+
+    QJsonObject json = QJsonDocument::fromJson(file.readAll()).object();
+    file.close();
+
+    return json;
+}
+
+
+bool TestScraper::scrape(QString searchName, int timeout)
+{
+    //Same path a collection scan takes: no parent, so errors are collected instead of shown
+    TheGamesDBScraper scraper;
+
+    QSignalSpy finishedSpy(&scraper, SIGNAL(queueFinished()));
+    QSignalSpy errorSpy(&scraper, SIGNAL(scrapeError(QString)));
+
+    int before = NetworkClient::instance()->getRequests();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    scraper.queueGameInfo(getIdentifier(searchName), searchName);
+    bool finished = finishedSpy.wait(timeout);
+
+    elapsed = timer.elapsed();
+    requests = NetworkClient::instance()->getRequests() - before;
+
+    errors.clear();
+    for (int i = 0; i < errorSpy.size(); i++)
+        errors << errorSpy.at(i).at(0).toString();
+
+    return finished;
+}
+
+
+void TestScraper::initTestCase()
+{
+    QVERIFY(sandbox.isValid());
+
+    //Settings and caches go to throwaway locations, the real ones are never touched
+    QCoreApplication::setOrganizationName(ParentName);
+    QCoreApplication::setApplicationName(AppName);
+    QStandardPaths::setTestModeEnabled(true);
+    QSettings::setPath(QSettings::NativeFormat, QSettings::UserScope, sandbox.path());
+    QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, sandbox.path());
+    QDir::setCurrent(sandbox.path());
+
+    server = new StubServer(QFileInfo(QFINDTESTDATA("fixtures/search.json")).path(), this);
+    QVERIFY(server->isListening());
+
+    SETTINGS.setValue("TheGamesDB/url", server->getUrl());
+}
+
+
+void TestScraper::init()
+{
+    //Genre, developer and publisher lists are cached too, so each test starts from nothing
+    QDir cache(getCacheLocation());
+
+    foreach (QString entry, cache.entryList(QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot))
+    {
+        //Qt's HTTP cache stays open for the whole run
+        if (entry == "http")
+            continue;
+
+        if (QFileInfo(cache.absoluteFilePath(entry)).isDir())
+            QDir(cache.absoluteFilePath(entry)).removeRecursively();
+        else
+            cache.remove(entry);
+    }
+
+    SETTINGS.setValue("Other/scraperrate", 0);
+    SETTINGS.setValue("Other/scraperretries", 1);
+    SETTINGS.setValue("Other/networktimeout", 2);
+
+    server->setResponse(StubServer::Success);
+}
+
+
+void TestScraper::cleanupTestCase()
+{
+    QDir(getCacheLocation()).removeRecursively();
+}
+
+
+void TestScraper::success()
+{
+    QVERIFY(scrape("Super Mario 64"));
+
+    QJsonObject data = readGameData("Super Mario 64");
+    QString gameID = QString::number(server->getGameID("Super Mario 64"));
+    QCOMPARE(data.value("id").toString(), gameID);
+    QCOMPARE(data.value("game_title").toString(), QString("Super Mario 64"));
+    QCOMPARE(data.value("release_date").toString(), QString("1996-06-23"));
+    QCOMPARE(data.value("genres").toString(), QString("Platform"));
+    QCOMPARE(data.value("developer").toString(), QString("Nintendo EAD"));
+    QCOMPARE(data.value("publisher").toString(), QString("Nintendo"));
+    QCOMPARE(data.value("boxart").toString(), server->getUrl() + "/covers/thumb/boxart/front/" + gameID + "-1.png");
+
+    QString cover = getCacheLocation() + getIdentifier("Super Mario 64") + "/boxart-front.";
+    QVERIFY(QFile::exists(cover + "jpg") || QFile::exists(cover + "png"));
+
+    //The search, one request for each ID list and the cover
+    QCOMPARE(requests, 5);
+    QCOMPARE(server->getRequests("/Genres"), 1);
+    QVERIFY(errors.isEmpty());
+    QVERIFY2(elapsed < 3000, qPrintable(QString("Took %1 ms").arg(elapsed)));
+
+    //The lists are on disk now, so another game only needs its search and cover
+    QVERIFY(scrape("Mario Kart 64"));
+    QCOMPARE(readGameData("Mario Kart 64").value("genres").toString(), QString("Platform"));
+    QCOMPARE(requests, 2);
+
+    //A different dump of the same game is answered from the response cache
+    QVERIFY(scrape("Super Mario 64 (E) [!]"));
+    QCOMPARE(readGameData("Super Mario 64 (E) [!]").value("game_title").toString(), QString("Super Mario 64"));
+    QCOMPARE(requests, 1);
+}
+
+
+void TestScraper::notFound()
+{
+    server->setResponse(StubServer::NotFound);
+
+    QVERIFY(scrape("Missing Game"));
+
+    //Nothing is written, so the game is searched for again on the next scan
+    QVERIFY(!QFile::exists(getCacheLocation() + getIdentifier("Missing Game") + "/data.json"));
+    QVERIFY(NetworkClient::instance()->getResponse("search:missing game").isEmpty());
+    QCOMPARE(requests, 1);
+    QCOMPARE(errors.size(), 1);
+    QVERIFY(errors.first().contains("Missing Game"));
+}
+
+
+void TestScraper::malformed_data()
+{
+    QTest::addColumn<int>("response");
+
+    QTest::newRow("truncated") << int(StubServer::Malformed);
+    QTest::newRow("empty") << int(StubServer::Empty);
+}
+
+
+void TestScraper::malformed()
+{
+    QFETCH(int, response);
+    server->setResponse(StubServer::Response(response));
+
+    //The recovered search below is cached, so each row needs its own name
+    QString searchName = QString("Broken Reply ") + QTest::currentDataTag();
+    QString key = "search:" + searchName.toLower();
+
+    QVERIFY(scrape(searchName));
+
+    //A 200 with a body that doesn't parse must not be kept as "not found"
+    QVERIFY(!QFile::exists(getCacheLocation() + getIdentifier(searchName) + "/data.json"));
+    QVERIFY(NetworkClient::instance()->getResponse(key).isEmpty());
+    QCOMPARE(requests, 1);
+    QCOMPARE(errors.size(), 1);
+    QVERIFY(errors.first().contains("incomplete response"));
+
+    //Once the server recovers the game is found
+    server->setResponse(StubServer::Success);
+
+    QVERIFY(scrape(searchName));
+    QCOMPARE(readGameData(searchName).value("game_title").toString(), searchName);
+    QVERIFY(!NetworkClient::instance()->getResponse(key).isEmpty());
+}
+
+
+void TestScraper::slow()
+{
+    server->setResponse(StubServer::Slow, 500);
+
+    QVERIFY(scrape("Slow Game"));
+
+    QCOMPARE(readGameData("Slow Game").value("game_title").toString(), QString("Slow Game"));
+    QCOMPARE(requests, 5);
+    QVERIFY(errors.isEmpty());
+    QVERIFY2(elapsed >= 500 && elapsed < 3500, qPrintable(QString("Took %1 ms").arg(elapsed)));
+}
+
+
+void TestScraper::timeout()
+{
+    SETTINGS.setValue("Other/networktimeout", 1);
+    server->setResponse(StubServer::Timeout);
+
+    QVERIFY(scrape("Stalled Game", 15000));
+
+    //Timed out, retried once after a 0.5-1.5 s backoff, then timed out again
+    QVERIFY(!QFile::exists(getCacheLocation() + getIdentifier("Stalled Game") + "/data.json"));
+    QCOMPARE(requests, 2);
+    QCOMPARE(errors.size(), 1);
+    QVERIFY(errors.first().contains("timed out"));
+    QVERIFY2(elapsed >= 2500 && elapsed < 6000, qPrintable(QString("Took %1 ms").arg(elapsed)));
+}
+
+
+void TestScraper::bulk()
+{
+    //A collection scan of a few hundred ROMs, the way the background queue sees it
+    int romCount = 250;
+    int batchSize = 20;
+    SETTINGS.setValue("TheGamesDB/idbatch", batchSize);
+
+    QStringList identifiers, searchNames;
+    for (int i = 1; i <= romCount; i++)
+    {
+        searchNames << QString("Synthetic ROM %1").arg(i);
+        identifiers << getIdentifier(searchNames.last());
+    }
+
+    TheGamesDBScraper scraper;
+
+    QSignalSpy readySpy(&scraper, SIGNAL(gameInfoReady(QString)));
+    QSignalSpy finishedSpy(&scraper, SIGNAL(queueFinished()));
+    QSignalSpy errorSpy(&scraper, SIGNAL(scrapeError(QString)));
+    QSignalSpy statusSpy(&scraper, SIGNAL(statusUpdate(QString, int)));
+
+    //The server counts every request since it started, so only the difference is this test's
+    QStringList paths;
+    paths << "" << "/ByGameName" << "/covers/" << "/Genres" << "/Developers" << "/Publishers" << "/ByGameID";
+
+    QHash<QString, int> before;
+    foreach (QString path, paths)
+        before[path] = server->getRequests(path);
+
+    int clientBefore = NetworkClient::instance()->getRequests();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int i = 0; i < romCount; i++)
+        scraper.queueGameInfo(identifiers.at(i), searchNames.at(i));
+
+    QVERIFY(finishedSpy.wait(60000));
+    elapsed = timer.elapsed();
+
+    //One search and one cover for each game, and each ID list only once for the whole run
+    QCOMPARE(readySpy.size(), romCount);
+    QCOMPARE(server->getRequests("/ByGameName") - before["/ByGameName"], romCount);
+    QCOMPARE(server->getRequests("/covers/") - before["/covers/"], romCount);
+    QCOMPARE(server->getRequests("/Genres") - before["/Genres"], 1);
+    QCOMPARE(server->getRequests("/Developers") - before["/Developers"], 1);
+    QCOMPARE(server->getRequests("/Publishers") - before["/Publishers"], 1);
+    QCOMPARE(server->getRequests() - before[""], romCount * 2 + 3);
+    QCOMPARE(NetworkClient::instance()->getRequests() - clientBefore, romCount * 2 + 3);
+    QCOMPARE(errorSpy.size(), 0);
+
+    //The run's totals are reported once the queue is done
+    QCOMPARE(statusSpy.size(), 1);
+    QVERIFY(statusSpy.first().at(0).toString().contains(QString("%1 requests").arg(romCount * 2 + 3)));
+
+    QJsonObject data = readGameData(searchNames.last());
+    QCOMPARE(data.value("id").toString(), QString::number(server->getGameID(searchNames.last())));
+    QCOMPARE(data.value("genres").toString(), QString("Platform"));
+
+    //Four requests at a time against a local server. The bound is loose enough for a slow machine
+    //but still catches a queue that stalls or waits on the rate limiter
+    QVERIFY2(elapsed < 20000, qPrintable(QString("Scraped %1 ROMs in %2 ms").arg(romCount).arg(elapsed)));
+
+    //Refreshing asks for many games with each ByGameID request instead of searching again
+    readySpy.clear();
+    int refreshBefore = server->getRequests();
+    timer.restart();
+
+    scraper.refreshGameInfo(identifiers, searchNames);
+
+    QVERIFY(finishedSpy.wait(30000));
+    elapsed = timer.elapsed();
+
+    QCOMPARE(readySpy.size(), romCount);
+    QCOMPARE(server->getRequests() - refreshBefore, (romCount + batchSize - 1) / batchSize);
+    QCOMPARE(server->getRequests("/ByGameID") - before["/ByGameID"], (romCount + batchSize - 1) / batchSize);
+    QCOMPARE(readGameData(searchNames.first()).value("id").toString(),
+             QString::number(server->getGameID(searchNames.first())));
+    QCOMPARE(errorSpy.size(), 0);
+    QVERIFY2(elapsed < 5000, qPrintable(QString("Refreshed %1 ROMs in %2 ms").arg(romCount).arg(elapsed)));
+
+    //With the information deleted, scanning again is answered from the response cache alone
+    foreach (QString identifier, identifiers)
+        QFile::remove(getCacheLocation() + identifier + "/data.json");
+
+    TheGamesDBScraper rescan;
+    QSignalSpy rescanSpy(&rescan, SIGNAL(gameInfoReady(QString)));
+
+    int rescanBefore = server->getRequests();
+    timer.restart();
+
+    for (int i = 0; i < romCount; i++)
+        rescan.queueGameInfo(identifiers.at(i), searchNames.at(i));
+
+    elapsed = timer.elapsed();
+
+    QCOMPARE(rescanSpy.size(), romCount);
+    QCOMPARE(server->getRequests() - rescanBefore, 0);
+    QCOMPARE(readGameData(searchNames.last()).value("game_title").toString(), searchNames.last());
+    QVERIFY2(elapsed < 5000, qPrintable(QString("Rescanned %1 ROMs in %2 ms").arg(romCount).arg(elapsed)));
+}
+
+
+QTEST_GUILESS_MAIN(TestScraper)
+#include "tst_scraper.moc"